@@ -64,6 +64,9 @@
 #define A64_CC_AL 0x0e /* Always */
 #define A64_CC_NV 0x0f /* Always */
 
+#define A64_PRF_PLDL1STRM 0x01 /* Prefetch for load, streaming */
+#define A64_PRF_PSTL1STRM 0x11 /* Prefetch for store, streaming */
+
 #define ARM_CC_EQ 0x00 /* Z=1 */
 #define ARM_CC_NE 0x01 /* Z=0 */
 #define ARM_CC_CS 0x02 /* C=1 */
@@ -212,6 +215,7 @@ static inline uint32_t ldr_offset(uint8_t rn, uint8_t rt, uint16_t offset14) { A
 static inline uint32_t ldr_offset_postindex(uint8_t rn, uint8_t rt, int16_t offset9) { ASSERT_REG(rt); ASSERT_REG(rn); return I32(0xb8400400 | (rt & 31) | ((rn & 31) << 5) | ((offset9 & 0x1ff) << 12)); }
 static inline uint32_t ldr_offset_preindex(uint8_t rn, uint8_t rt, int16_t offset9) { ASSERT_REG(rt); ASSERT_REG(rn); return I32(0xb8400c00 | (rt & 31) | ((rn & 31) << 5) | ((offset9 & 0x1ff) << 12)); }
 static inline uint32_t ldr64_offset(uint8_t rn, uint8_t rt, uint16_t offset15) { ASSERT_REG(rt); ASSERT_REG(rn); return I32(0xf9400000 | (rt & 31) | ((rn & 31) << 5) | (((offset15 >> 3) & 0xfff) << 10)); }
+static inline uint32_t prfm_offset(uint8_t rn, uint8_t prfop, uint16_t offset15) { ASSERT_REG(rn); return I32(0xf9800000 | (prfop & 31) | ((rn & 31) << 5) | (((offset15 >> 3) & 0xfff) << 10)); }
 static inline uint32_t ldr64_offset_postindex(uint8_t rn, uint8_t rt, int16_t offset9) { ASSERT_REG(rt); ASSERT_REG(rn); return I32(0xf8400400 | (rt & 31) | ((rn & 31) << 5) | ((offset9 & 0x1ff) << 12)); }
 static inline uint32_t ldr64_offset_preindex(uint8_t rn, uint8_t rt, int16_t offset9) { ASSERT_REG(rt); ASSERT_REG(rn); return I32(0xf8400c00 | (rt & 31) | ((rn & 31) << 5) | ((offset9 & 0x1ff) << 12)); }
 static inline uint32_t ldrb_offset(uint8_t rn, uint8_t rt, uint16_t offset12) { ASSERT_REG(rt); ASSERT_REG(rn); return I32(0x39400000 | (rt & 31) | ((rn & 31) << 5) | ((offset12 & 0xfff) << 10)); }
@@ -572,6 +576,7 @@ static inline uint32_t fldq_preindex(uint8_t v_dst, uint8_t base, int16_t offset
 static inline uint32_t fldq_postindex(uint8_t v_dst, uint8_t base, int16_t offset9) { return I32(0x3cc00400 | ((base & 31) << 5) | (v_dst & 31) | ((offset9 & 0x1ff) << 12)); }
 static inline uint32_t fldq(uint8_t v_dst, uint8_t base, int16_t offset9) { return I32(0x3cc00000 | ((base & 31) << 5) | (v_dst & 31) | ((offset9 & 0x1ff) << 12)); }
 static inline uint32_t fldq_pimm(uint8_t v_dst, uint8_t base, uint16_t offset12) { return I32(0x3dc00000 | ((base & 31) << 5) | (v_dst & 31) | ((offset12 & 0xfff) << 10)); }
+static inline uint32_t fldpq_postindex(uint8_t v_dst1, uint8_t v_dst2, uint8_t base, int16_t imm) { return I32(0xacc00000 | ((base & 31) << 5) | (v_dst1 & 31) | ((v_dst2 & 31) << 10) | (((imm / 16) & 0x7f) << 15)); }
 
 static inline uint32_t fldd_pcrel(uint8_t v_dst, int32_t imm19) { return I32(0x5c000000 | (v_dst & 31) | ((imm19 & 0x7ffff) << 5)); }
 static inline uint32_t flds_pcrel(uint8_t v_dst, int32_t imm19) { return I32(0x1c000000 | (v_dst & 31) | ((imm19 & 0x7ffff) << 5)); }
@@ -580,6 +585,7 @@ static inline uint32_t fldq_pcrel(uint8_t v_dst, int32_t imm19) { return I32(0x9
 enum TS { TS_B = 1, TS_H = 2, TS_S = 4, TS_D = 8 };
 static inline uint32_t mov_reg_to_simd(uint8_t v_dst, enum TS ts, uint8_t index, uint8_t rn) { return I32(0x4e001c00 | (ts == TS_B ? ((index & 0xf) << 17) : ts == TS_H ? ((index & 7) << 18) : ts == TS_S ? ((index & 3) << 19) : ts == TS_D ? ((index & 1) << 20) : 0) | ((ts & 31) << 16) | (v_dst & 31) | ((rn & 31) << 5)); }
 static inline uint32_t mov_simd_to_reg(uint8_t rd, uint8_t v_src, enum TS ts, uint8_t index) { return I32((ts == TS_D ? 0x4e003c00 : 0x0e003c00) | (ts == TS_B ? ((index & 0xf) << 17) : ts == TS_H ? ((index & 7) << 18) : ts == TS_S ? ((index & 3) << 19) : ts == TS_D ? ((index & 1) << 20) : 0) | ((ts & 31) << 16) | (rd & 31) | ((v_src & 31) << 5)); }
+static inline uint32_t dup_reg(uint8_t v_dst, enum TS ts, uint8_t rn) { return I32(0x4e000c00 | ((ts & 31) << 16) | (v_dst & 31) | ((rn & 31) << 5)); }
 static inline uint32_t fmsr(uint8_t v_dst, uint8_t src) { return mov_reg_to_simd(v_dst, TS_S, 0, src); }
 static inline uint32_t fmdhr(uint8_t v_dst, uint8_t src) { return mov_reg_to_simd(v_dst, TS_S, 1, src); }
 static inline uint32_t fmdlr(uint8_t v_dst, uint8_t src) { return mov_reg_to_simd(v_dst, TS_S, 0, src); }
@@ -604,6 +610,7 @@ static inline uint32_t fstq_preindex(uint8_t v_dst, uint8_t base, int16_t offset
 static inline uint32_t fstq_postindex(uint8_t v_dst, uint8_t base, int16_t offset9) { return I32(0x3c800400 | ((base & 31) << 5) | (v_dst & 31) | ((offset9 & 0x1ff) << 12)); }
 static inline uint32_t fstq(uint8_t v_dst, uint8_t base, int16_t offset9) { return I32(0x3c800000 | ((base & 31) << 5) | (v_dst & 31) | ((offset9 & 0x1ff) << 12)); }
 static inline uint32_t fstq_pimm(uint8_t v_dst, uint8_t base, uint16_t offset12) { return I32(0x3d800000 | ((base & 31) << 5) | (v_dst & 31) | ((offset12 & 0xfff) << 10)); }
+static inline uint32_t fstpq_postindex(uint8_t v_src1, uint8_t v_src2, uint8_t base, int16_t imm) { return I32(0xac800000 | ((base & 31) << 5) | (v_src1 & 31) | ((v_src2 & 31) << 10) | (((imm / 16) & 0x7f) << 15)); }
 
 
 static inline uint32_t fmov_f64(uint8_t v_dst, uint8_t imm) { return I32(0x1e601000 | (imm << 13) | (v_dst & 31)); }
@@ -1408,4 +1415,6 @@ uint32_t number_to_mask(uint32_t number)
     }
 }
 
+uint32_t *A64_Peephole(uint32_t *start, uint32_t *end, uint16_t live_temps, uint8_t ctx);
+
 #endif /* _A64_H */
@@ -16,6 +16,7 @@
 #include "nodes.h"
 #include "md5.h"
 #include "lists.h"
+#include "cache.h"
 
 struct M68KLocalState {
     void *          mls_M68kPtr;
@@ -24,9 +25,67 @@ struct M68KLocalState {
     int32_t         mls_PCRel;
 };
 
+struct M68KTranslationUnit;
+
+/*
+    Exit of a translation unit with statically known m68k target. As long as the
+    target unit is not present in the cache, the link is kept in a list of pending
+    links and the slot in ARM code holds a plain return to the dispatcher. Once
+    the target exists, the slot is patched into direct branch to its ARM code and
+    the link moves to the target's mt_Incoming list.
+*/
+struct M68KUnitLink {
+    struct Node     ml_Node;
+    uint32_t *      ml_Slot;
+    uint16_t *      ml_M68kTarget;
+    struct M68KTranslationUnit * ml_Target;
+    uint32_t        ml_Misses;
+    uint32_t        ml_Count;
+    uint16_t *      ml_M68kSource;
+    struct M68KTranslationUnit * ml_Unit;
+};
+
+/*
+    Entry of the unit on the list of units overlapping a 4KB page of m68k code. Units spanning
+    more than EMU68_UNIT_MAX_PAGES pages have one entry on the list of wide units instead.
+*/
+struct M68KUnitPage {
+    struct Node     up_Node;
+    struct M68KTranslationUnit * up_Unit;
+    uint32_t        up_Page;
+};
+
+#define UNIT_PAGE_WIDE  0xffffffff
+
+/*
+    Instruction boundary inside of the unit where execution can start, with no m68k state kept in
+    host registers. Offsets are counted in words from mt_M68kLow and in AArch64 instructions from
+    mt_ARMCode. se_InsnCount is the number of m68k instructions translated before the boundary and
+    se_PCRel the offset of m68k PC not yet added to the PC register.
+*/
+struct M68KSideEntry {
+    uint16_t        se_M68kOffset;
+    uint16_t        se_ARMOffset;
+    uint16_t        se_InsnCount;
+    int16_t         se_PCRel;
+};
+
+/*
+    Start of the code of an m68k instruction inside of the unit, ordered by ARM offset. Gives the m68k
+    PC of a host instruction while the PC register lags behind. Offsets are counted in AArch64
+    instructions from mt_ARMCode and in bytes from mt_M68kAddress. Instructions too far away from
+    the entry are marked with PCMAP_UNKNOWN.
+*/
+struct M68KPCMap {
+    uint16_t        pm_ARMOffset;
+    int16_t         pm_M68kOffset;
+};
+
+#define PCMAP_UNKNOWN   -32768
+
 struct M68KTranslationUnit {
-    struct Node     mt_HashNode;
     struct Node     mt_LRUNode;
+    uint32_t        mt_AllocSize;   /* Size of the block in JIT arena, bit 0 set once released */
     uint16_t *      mt_M68kAddress;
     uint16_t *      mt_M68kLow;
     uint16_t *      mt_M68kHigh;
@@ -35,10 +94,22 @@ struct M68KTranslationUnit {
     uint32_t        mt_Conditionals;
     uint32_t        mt_M68kInsnCnt;
     uint32_t        mt_ARMInsnCnt;
+    uint8_t         mt_Referenced;  /* Set when the unit is entered from dispatcher, cleared by eviction clock */
+    uint8_t         mt_Tier;        /* Translation tier, 2 for hot code retranslated by M68K_PromoteUnit */
+    uint16_t        mt_VerifySlot;  /* Slot in background verification queue plus one, 0 if not queued */
     uint64_t        mt_UseCount;
     uint64_t        mt_FetchCount;
     void *          mt_ARMEntryPoint;
     struct M68KLocalState *  mt_LocalState;
+    struct List     mt_Incoming;
+    struct M68KUnitLink *    mt_Links;
+    uint32_t        mt_LinkCount;
+    uint32_t        mt_PageCount;
+    struct M68KUnitPage *    mt_Pages;
+    uint32_t        mt_EntryCount;
+    struct M68KSideEntry *   mt_Entries;
+    uint32_t        mt_PCMapCount;
+    struct M68KPCMap *       mt_PCMap;
     uint32_t        mt_CRC32;
     uint32_t        mt_ARMCode[]
 #ifdef __aarch64__
@@ -48,6 +119,23 @@ struct M68KTranslationUnit {
 #endif
 };
 
+/*
+    Slot of the unit lookup table. The table is indexed by open addressing, four slots form one
+    64-byte line. Lookup probes the slots linearly starting at the line selected by the m68k
+    address, until the address or an empty slot is found.
+*/
+struct M68KUnitSlot {
+    struct M68KTranslationUnit * us_Unit;
+    uint32_t        us_M68kAddress;
+    uint32_t        us_Pad;
+};
+
+/* Odd m68k addresses never matching any PC */
+#define UNIT_SLOT_EMPTY     0xffffffff
+#define UNIT_SLOT_DELETED   0xfffffffd
+
+#define JIT_RETURN_STACK_SIZE   16
+
 struct M68KState
 {
     /* Integer part */
@@ -123,6 +211,19 @@ struct M68KState
     uint32_t JIT_SOFTFLUSH_THRESH;
     uint32_t JIT_CONTROL;
     uint32_t JIT_CONTROL2;
+    uint32_t JIT_TIER_THRESH;
+    uint32_t JIT_SNAPSHOT_SIZE;
+    uint64_t JIT_BRANCH_SITE;
+    uint64_t JIT_TIER_UNIT;
+
+    /* Runtime return address prediction, maintained by JIT code */
+    uint32_t JIT_RETURN_TOP;
+    uint32_t JIT_RETURN_DEPTH;
+    struct {
+        uint32_t M68K;
+        uint32_t __pad;
+        uint64_t ARM;
+    } JIT_RETURN_STACK[JIT_RETURN_STACK_SIZE];
 };
 
 #define JCCB_SOFT               0
@@ -139,12 +240,43 @@ struct M68KState
 #define JC2F_CHIP_SLOWDOWN              (1 << JC2B_CHIP_SLOWDOWN)
 #define JC2B_DBF_SLOWDOWN               1
 #define JC2F_DBF_SLOWDOWN               (1 << JC2B_DBF_SLOWDOWN)
+#define JC2B_CHAIN_UNITS                2
+#define JC2F_CHAIN_UNITS                (1 << JC2B_CHAIN_UNITS)
 #define JC2B_CCR_SCAN_DEPTH             3
 #define JC2_CCR_SCAN_MASK               0x1f
 #define JC2B_CHIP_SLOWDOWN_RATIO        8
 #define JC2_CHIP_SLOWDOWN_RATIO_MASK    0x07
 #define JC2B_BLITWAIT                   11
 #define JC2F_BLITWAIT                   (1 << JC2B_BLITWAIT)
+#define JC2B_BRANCH_CACHE               12
+#define JC2F_BRANCH_CACHE               (1 << JC2B_BRANCH_CACHE)
+#define JC2B_RETURN_STACK               13
+#define JC2F_RETURN_STACK               (1 << JC2B_RETURN_STACK)
+#define JC2B_TIERED_JIT                 14
+#define JC2F_TIERED_JIT                 (1 << JC2B_TIERED_JIT)
+#define JC2B_LAZY_FLAGS                 15
+#define JC2F_LAZY_FLAGS                 (1 << JC2B_LAZY_FLAGS)
+#define JC2B_IR_PASSES                  16
+#define JC2F_IR_PASSES                  (1 << JC2B_IR_PASSES)
+#define JC2B_PEEPHOLE                   17
+#define JC2F_PEEPHOLE                   (1 << JC2B_PEEPHOLE)
+#define JC2B_SIDE_ENTRIES               18
+#define JC2F_SIDE_ENTRIES               (1 << JC2B_SIDE_ENTRIES)
+#define JC2B_SMC_PROTECT                19
+#define JC2F_SMC_PROTECT                (1 << JC2B_SMC_PROTECT)
+#define JC2B_BG_VERIFY                  20
+#define JC2F_BG_VERIFY                  (1 << JC2B_BG_VERIFY)
+#define JC2B_PIN                        22
+#define JC2_PIN_MASK                    0x07
+#define JC2_PIN_ROM                     1
+#define JC2_PIN_HOT                     2
+#define JC2_PIN_RAM                     4
+#define JC2B_WARM_RESET                 25
+#define JC2F_WARM_RESET                 (1 << JC2B_WARM_RESET)
+#define JC2B_BLOCK_LOOPS                26
+#define JC2F_BLOCK_LOOPS                (1 << JC2B_BLOCK_LOOPS)
+#define JC2B_PREFETCH                   27
+#define JC2_PREFETCH_MASK               0x1f
 
 #define DCB_VERBOSE 0
 #define DCB_VERBOSE_MASK 0x3
@@ -387,12 +519,17 @@ struct M68KState
 uint32_t *EMIT_GetOffsetPC(uint32_t *ptr, int8_t *offset);
 uint32_t *EMIT_AdvancePC(uint32_t *ptr, uint8_t offset);
 uint32_t *EMIT_FlushPC(uint32_t *ptr);
+uint32_t *EMIT_SyncPC(uint32_t *ptr, int32_t offset);
 uint32_t *EMIT_ResetOffsetPC(uint32_t *ptr);
 uint32_t *EMIT_LoadFromEffectiveAddress(uint32_t *ptr, uint8_t size, uint8_t *arm_reg, uint8_t ea, uint16_t *m68k_ptr, uint8_t *ext_words, uint8_t read_only, int32_t *imm_offset);
 uint32_t *EMIT_StoreToEffectiveAddress(uint32_t *ptr, uint8_t size, uint8_t *arm_reg, uint8_t ea, uint16_t *m68k_ptr, uint8_t *ext_words, int sign_extend);
 uint32_t *EMIT_Exception(uint32_t *ptr, uint16_t exception, uint8_t format, ...);
 uint32_t *EMIT_LocalExit(uint32_t *ptr, uint32_t insn_count_fixup);
+uint32_t *EMIT_LinkedExit(uint32_t *ptr, uint32_t insn_count_fixup, uint16_t *m68k_target);
+uint32_t *EMIT_PushReturnStack(uint32_t *ptr, uint16_t *ret_addr);
+uint32_t *EMIT_ResetReturnStack(uint32_t *ptr, uint8_t ctx);
 uint32_t *EMIT_JumpOnCondition(uint32_t *ptr, uint8_t m68k_condition, uint32_t distance);
+uint32_t *EMIT_LoopPrefetch(uint32_t *ptr, uint16_t *loop_start, uint16_t *loop_end);
 
 uint32_t *EMIT_line0(uint32_t *ptr, uint16_t **m68k_ptr, uint16_t *insn_consumed);
 uint32_t *EMIT_line4(uint32_t *ptr, uint16_t **m68k_ptr, uint16_t *insn_consumed);
@@ -483,10 +620,83 @@ int M68K_IsBranch(uint16_t *insn_stream);
 uint8_t EMIT_TestCondition(uint32_t **pptr, uint8_t m68k_condition);
 uint8_t EMIT_TestFPUCondition(uint32_t **pptr, uint8_t m68k_condition);
 uint8_t M68K_GetSRMask(uint16_t *m68k_stream);
+uint8_t M68K_GetSRMaskAfterBranch(uint16_t *insn_stream, uint8_t mask);
+/* Instruction of the straight line code following entry of the unit being translated */
+struct DecodedInsn {
+    uint16_t *  di_Insn;
+    uint16_t *  di_Next;        /* Fall-through successor, NULL if there is none */
+    uint16_t *  di_Target;      /* Static branch target, NULL if there is none */
+    int16_t     di_NextIdx;     /* Index of successors within the window or -1 */
+    int16_t     di_TargetIdx;
+    uint8_t     di_Length;
+    uint8_t     di_Branch;
+    uint8_t     di_Sets;
+    uint8_t     di_Needs;
+    uint8_t     di_LiveIn;      /* Flags live before and after the instruction */
+    uint8_t     di_LiveOut;
+    uint8_t     di_LiveExt;     /* Flags live at successors outside of the window */
+};
+
+void M68K_DecodeUnit(uint16_t *insn_stream, int depth);
+void M68K_ReleaseDecodedUnit();
+int M68K_GetDecodedCount();
+struct DecodedInsn *M68K_GetDecodedInsn(int idx);
+int M68K_FindDecodedInsn(uint16_t *insn_stream);
+void M68K_BuildIR();
+int M68K_IRSkip(uint16_t *insn_stream, int insn_budget);
+uint32_t *M68K_IRLower(uint32_t *ptr, uint16_t **m68k_ptr);
+void M68K_IRAdvance(uint16_t *insn_stream, uint16_t *next);
+
+/* Instruction words of the unit being translated, copied once by M68K_DecodeUnit */
+extern uint16_t *insn_window_base;
+extern uint32_t insn_window_size;
+extern uint16_t insn_window_words[];
+
+/* Read instruction stream of the unit being translated. Words outside of the decoded window go through the cache */
+static inline uint16_t M68K_FetchWord(uint32_t address)
+{
+    uint32_t offset = (address - (uint32_t)(uintptr_t)insn_window_base) >> 1;
+
+    if ((address & 1) == 0 && offset < insn_window_size)
+        return insn_window_words[offset];
+
+    return cache_read_16(ICACHE, address);
+}
+
+static inline uint32_t M68K_FetchLong(uint32_t address)
+{
+    return ((uint32_t)M68K_FetchWord(address) << 16) | M68K_FetchWord(address + 2);
+}
 void M68K_InitializeCache();
 struct M68KTranslationUnit *M68K_GetTranslationUnit(uint16_t *ptr);
 void *M68K_TranslateNoCache(uint16_t *m68kcodeptr);
 struct M68KTranslationUnit *M68K_VerifyUnit(struct M68KTranslationUnit *unit);
+struct M68KTranslationUnit *M68K_FindUnit(uint16_t *m68k_address);
+void M68K_InsertUnit(struct M68KTranslationUnit *unit);
+void M68K_RemoveUnit(struct M68KTranslationUnit *unit);
+void M68K_FreeUnit(struct M68KTranslationUnit *unit);
+uint32_t M68K_GetCacheFree();
+struct List *M68K_GetPageUnits(uint32_t page);
+struct M68KTranslationUnit *M68K_PromoteUnit(struct M68KTranslationUnit *unit);
+int M68K_IsHotExit();
+void M68K_SetExitTarget(uint16_t *m68k_target);
+void M68K_LinkUnit(struct M68KTranslationUnit *unit);
+void M68K_UnlinkUnit(struct M68KTranslationUnit *unit, int discard);
+void M68K_MoveUnit(struct M68KTranslationUnit *unit, struct M68KTranslationUnit *copy);
+void M68K_SoftFlushUnit(struct M68KTranslationUnit *unit);
+void M68K_SoftFlushAll();
+void M68K_ResetCache();
+void M68K_WarmReset(struct M68KState *ctx);
+uint32_t M68K_SaveSnapshot(uint32_t address);
+uint32_t M68K_FindSnapshot(const void *image, uint32_t size);
+void M68K_LoadSnapshot(const void *snapshot, uint32_t size);
+void M68K_VerifyWorker();
+int M68K_CodePageWritten(uint32_t address);
+void M68K_ProtectUnitPages(struct M68KTranslationUnit *unit);
+void M68K_SetIndirectExit();
+void M68K_SetReturnExit();
+void M68K_UpdateBranchCache(struct M68KUnitLink *site, struct M68KTranslationUnit *unit);
+uint32_t M68K_GetPCFromARM(uintptr_t arm_pc);
 void M68K_DumpStats();
 uint8_t M68K_GetCC(uint32_t **ptr);
 uint8_t M68K_ModifyCC(uint32_t **ptr);
@@ -54,6 +54,15 @@ uint8_t RA_GetCC(uint32_t **ptr);
 uint8_t RA_ModifyCC(uint32_t **ptr);
 void RA_FlushCC(uint32_t **ptr);
 void RA_StoreCC(uint32_t **ptr);
+
+#define LAZY_CC_NZnCV   1   /* NZCV of a subtraction, host C inverted */
+#define LAZY_CC_NZ00    2   /* NZ of a test, host V and C clear */
+
+void RA_AllowLazyCC(uint8_t m68k_condition, uint8_t after_mask);
+uint8_t RA_DeferCC(uint8_t kind, uint8_t update_mask);
+uint8_t RA_ConsumeLazyCC(uint32_t **ptr, uint8_t m68k_condition);
+void RA_ResolveLazyCC(uint32_t **ptr);
+int RA_IsLazyCC();
 uint8_t RA_GetFPCR(uint32_t **ptr);
 uint8_t RA_ModifyFPCR(uint32_t **ptr);
 void RA_FlushFPCR(uint32_t **ptr);
@@ -47,10 +47,60 @@
 #define EMU68_PC_REG_HISTORY    0
 #define EMU68_CCR_SCAN_DEPTH    20
 
-#define EMU68_HASHSIZE          65536
-#define EMU68_HASHMASK          (EMU68_HASHSIZE - 1)
 #define EMU68_HASHSHIFT         5
 
+/* Unit lookup table, number of slots (16 bytes each, 4 per line) and bytes offset masks */
+#define EMU68_UNIT_TABLE_SIZE   131072
+#define EMU68_UNIT_TABLE_MASK   (EMU68_UNIT_TABLE_SIZE * 16 - 1)
+#define EMU68_UNIT_TABLE_LINE_MASK (EMU68_UNIT_TABLE_MASK & ~63)
+#define EMU68_UNIT_TABLE_LIMIT  (EMU68_UNIT_TABLE_SIZE / 8 * 7)
+
+/* Directory of units overlapping 4KB m68k pages, used by CINV/CPUSH */
+#define EMU68_PAGE_HASHSIZE     4096
+#define EMU68_PAGE_HASHMASK     (EMU68_PAGE_HASHSIZE - 1)
+#define EMU68_UNIT_MAX_PAGES    16
+
+/* JIT units are emitted directly into a ring arena and evicted from its tail instead of TLSF,
+   pinned and recently used units at the tail get a second chance at the head */
+#define EMU68_JIT_ARENA         1
+/* Space in JIT pool left to TLSF when the arena is created */
+#define EMU68_JIT_ARENA_RESERVE (2*1024*1024)
+
+#define EMU68_BLOCK_CHAINING    1
+#define EMU68_LINK_HASHSIZE     4096
+#define EMU68_LINK_HASHMASK     (EMU68_LINK_HASHSIZE - 1)
+#define EMU68_BRANCH_CACHE      1
+#define EMU68_BRANCH_CACHE_LIMIT 32
+#define EMU68_SHADOW_RETURN_STACK 1
+#define EMU68_TIERED_JIT        1
+#define EMU68_TIER_THRESHOLD    256
+#define EMU68_TIER1_INSN_DEPTH  32
+#define EMU68_TIER1_INLINE_RANGE 256
+#define EMU68_TIER1_CCR_SCAN_DEPTH 4
+#define EMU68_LAZY_FLAGS        1
+#define EMU68_IR_PASSES         0
+#define EMU68_PEEPHOLE          1
+#define EMU68_SIDE_ENTRIES      1
+#define EMU68_UNIT_MAX_ENTRIES  32
+/* Detect writes into translated code by write protecting its pages, enabled with JITCTRL2 */
+#define EMU68_SMC_PROTECT       1
+/* Verify soft flushed units on a spare CPU core, enabled with JITCTRL2 */
+#define EMU68_BACKGROUND_VERIFY 1
+#define EMU68_VERIFY_QUEUE_SIZE 4096
+/* Save units translated from ROM with JITSNAPSHOT and load them back at boot */
+#define EMU68_JIT_SNAPSHOT      1
+/* Keep units of selected kinds in the cache while others are evicted, chosen with JITCTRL2 */
+#define EMU68_PIN_UNITS         1
+/* Restart m68k on reset of the Amiga without rebooting, JIT cache is kept. Enabled with JITCTRL2 */
+#define EMU68_WARM_RESET        1
+/* Keep the PC register behind within a unit, m68k PC of host code is found in a table of the unit */
+#define EMU68_LAZY_PC           1
+/* Move blocks of DBF copy and fill loops with NEON loads and stores, enabled with JITCTRL2 */
+#define EMU68_BLOCK_LOOPS       1
+/* Prefetch (An)+ and -(An) streams of loops, distance in cache lines of 64 bytes is set in JITCTRL2 */
+#define EMU68_LOOP_PREFETCH     1
+#define EMU68_PREFETCH_DISTANCE 4
+
 #ifdef PISTORM
 
 /* Speed for bitbang RS232... */
@@ -83,6 +133,9 @@
 #define KERNEL_SYS_PAGES        16
 #define KERNEL_JIT_PAGES        32
 #define KERNEL_RSRVD_PAGES      ((KERNEL_JIT_PAGES) + (KERNEL_SYS_PAGES))
+/* Upper bound of 2MB pages JIT pool may grow by at runtime, reserved at boot with jit_max=.
+   Whole pool has to stay within 128MB, the range of b instruction linking units together */
+#define KERNEL_JIT_MAX_PAGES    (64 - (KERNEL_JIT_PAGES))
 
 #define EMU68_LOG_FETCHES       0
 #define EMU68_LOG_USES          0
@@ -15,5 +15,7 @@
 void mmu_init();
 uintptr_t mmu_virt2phys(uintptr_t addr);
 void mmu_map(uintptr_t phys, uintptr_t virt, uintptr_t length, uint32_t attr_low, uint32_t attr_high);
+void mmu_map_4k(uintptr_t phys, uintptr_t virt, uintptr_t length, uint32_t attr_low, uint32_t attr_high);
+int mmu_protect_page(uintptr_t virt, int protect);
 
 #endif /* _MMU_H */
\ No newline at end of file
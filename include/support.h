@@ -139,6 +139,8 @@ extern void * firmware_file;
 extern uint32_t firmware_size;
 extern void * tlsf;
 extern void * jit_tlsf;
+extern uintptr_t jit_reserve;
+extern uintptr_t jit_reserve_size;
 
 struct MemoryBlock {
     uintptr_t mb_Base;
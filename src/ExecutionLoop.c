@@ -8,7 +8,7 @@
 #endif
 #endif
 
-extern struct List ICache[EMU68_HASHSIZE];
+extern struct M68KUnitSlot UnitTable[EMU68_UNIT_TABLE_SIZE];
 void M68K_LoadContext(struct M68KState *ctx);
 void M68K_SaveContext(struct M68KState *ctx);
 
@@ -24,48 +24,26 @@ static inline struct M68KTranslationUnit *FindUnit()
 {
     register uint16_t *PC asm("x18");
     
-    /* Perform search */
-    uint32_t hash = (uint32_t)(uintptr_t)PC;
-    struct List *bucket = &ICache[(hash >> EMU68_HASHSHIFT) & EMU68_HASHMASK];
-    struct M68KTranslationUnit *node;
+    /* Perform search. Probe the slots starting at the line selected by PC, empty slot ends the search */
+    uint32_t offset = ((uint32_t)(uintptr_t)PC << 2) & EMU68_UNIT_TABLE_LINE_MASK;
     
-    /* Go through the list of translated units */
-    ForeachNode(bucket, node)
+    while (1)
     {
+        struct M68KUnitSlot *slot = (struct M68KUnitSlot *)((uintptr_t)UnitTable + offset);
+        uint32_t address = slot->us_M68kAddress;
+
         /* Force reload of PC*/
         asm volatile("":"=r"(PC));
 
         /* Check if unit is found */
-        if (node->mt_M68kAddress == PC)
-        {
-#if 0
-            /* Move node to front of the list */
-            REMOVE(&node->mt_HashNode);
-            ADDHEAD(bucket, &node->mt_HashNode);
-#elif 0
-            struct Node *prev = node->mt_HashNode.ln_Pred;
-            struct Node *succ = node->mt_HashNode.ln_Succ;
-            struct Node *prevprev = prev->ln_Pred;
-            
-            /* If node is not head, then move it one level up */
-            if (prevprev != NULL)
-            {
-                node->mt_HashNode.ln_Pred = prevprev;
-                node->mt_HashNode.ln_Succ = prev;
-
-                prevprev->ln_Succ = &node->mt_HashNode;
+        if (address == (uint32_t)(uintptr_t)PC)
+            return slot->us_Unit;
 
-                prev->ln_Succ = succ;
-                prev->ln_Pred = &node->mt_HashNode;
+        if (address == UNIT_SLOT_EMPTY)
+            return NULL;
 
-                succ->ln_Pred = prev;
-            }
-#endif                   
-            return node;    
-        }
+        offset = (offset + sizeof(struct M68KUnitSlot)) & EMU68_UNIT_TABLE_MASK;
     }
-
-    return NULL;
 }
 
 #ifdef PISTORM
@@ -151,6 +129,21 @@ void MainLoop()
             uint32_t vector;
             uint32_t vbr;
 
+#if defined(PISTORM) && EMU68_WARM_RESET
+            /* Amiga is being reset. Restart m68k from reset vector, keep translated ROM code */
+            if (unlikely(ctx->INT.RESET != 0))
+            {
+                M68K_SaveContext(ctx);
+                M68K_WarmReset(ctx);
+                M68K_LoadContext(getCTX());
+
+                /* PC has changed, force lookup of the unit */
+                asm volatile("":"=r"(PC));
+                setLastPC((void*)~(0));
+                continue;
+            }
+#endif
+
             /* Find out requested IPL level based on ARM state and real IPL line */
             if (ctx->INT.ARM_err)
             {
@@ -204,6 +197,10 @@ void MainLoop()
             {
                 register uint64_t sp asm("r29");
 
+#if EMU68_SHADOW_RETURN_STACK
+                ctx->JIT_RETURN_DEPTH = 0;
+#endif
+
                 if (likely((SR & SR_S) == 0))
                 {
                     /* If we are not yet in supervisor mode, the USP needs to be updated */
@@ -266,6 +263,11 @@ void MainLoop()
             /* The last PC is the same as currently set PC? */
             if (LastPC == PC)
             {
+#if EMU68_BRANCH_CACHE
+                /* Branch site left by the previous unit is not updated here, forget it */
+                if (unlikely(ctx->JIT_BRANCH_SITE != 0))
+                    ctx->JIT_BRANCH_SITE = 0;
+#endif
                 asm volatile("":"=r"(ARM));
                 /* Jump to the code now */
                 CallARMCode();
@@ -279,6 +281,44 @@ void MainLoop()
                 /* Unit exists ? */
                 if (node != NULL)
                 {
+                    /* Mark the unit referenced for the eviction clock. Write only if the bit was clear */
+                    if (unlikely(node->mt_Referenced == 0))
+                        node->mt_Referenced = 1;
+
+#if EMU68_BRANCH_CACHE
+                    /* Previous unit missed in its inline branch cache. Update it unless the site is hopelessly polymorphic */
+                    if (unlikely(ctx->JIT_BRANCH_SITE != 0))
+                    {
+                        struct M68KUnitLink *site = (struct M68KUnitLink *)(uintptr_t)ctx->JIT_BRANCH_SITE;
+                        ctx->JIT_BRANCH_SITE = 0;
+
+                        if (site->ml_Misses < EMU68_BRANCH_CACHE_LIMIT)
+                        {
+                            site->ml_Misses++;
+                            M68K_SaveContext(ctx);
+                            M68K_UpdateBranchCache(site, node);
+                            M68K_LoadContext(getCTX());
+                            asm volatile("":"=r"(PC));
+                        }
+                    }
+#endif
+#if EMU68_TIERED_JIT
+                    /* First tier unit became hot. Replace it with better translation */
+                    if (unlikely(ctx->JIT_TIER_UNIT != 0))
+                    {
+                        struct M68KTranslationUnit *hot = (struct M68KTranslationUnit *)(uintptr_t)(ctx->JIT_TIER_UNIT -
+                            __builtin_offsetof(struct M68KTranslationUnit, mt_UseCount));
+                        ctx->JIT_TIER_UNIT = 0;
+
+                        if (hot == node)
+                        {
+                            M68K_SaveContext(ctx);
+                            node = M68K_PromoteUnit(node);
+                            M68K_LoadContext(getCTX());
+                            asm volatile("":"=r"(PC));
+                        }
+                    }
+#endif
                     /* Store m68k PC of corresponding ARM code in TPIDR_EL1 */
                     asm volatile("msr TPIDR_EL1, %0"::"r"(PC));
 
@@ -298,6 +338,19 @@ void MainLoop()
                 M68K_SaveContext(ctx);
                 /* Get the code. This never fails */
                 node = M68K_GetTranslationUnit(copyPC);
+#if EMU68_BRANCH_CACHE
+                if (unlikely(ctx->JIT_BRANCH_SITE != 0))
+                {
+                    struct M68KUnitLink *site = (struct M68KUnitLink *)(uintptr_t)ctx->JIT_BRANCH_SITE;
+                    ctx->JIT_BRANCH_SITE = 0;
+
+                    if (site->ml_Misses < EMU68_BRANCH_CACHE_LIMIT)
+                    {
+                        site->ml_Misses++;
+                        M68K_UpdateBranchCache(site, node);
+                    }
+                }
+#endif
                 /* Load CPU context */
                 M68K_LoadContext(getCTX());
                 asm volatile("msr TPIDR_EL1, %0"::"r"(PC));
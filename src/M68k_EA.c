@@ -570,7 +570,7 @@ uint32_t *EMIT_LoadFromEffectiveAddress(uint32_t *ptr, uint8_t size, uint8_t *ar
                 }
                 break;
             case 0:
-                kprintf("Load form EA: Dn with wrong operand size! Opcode %04x at %08x\n", cache_read_16(ICACHE, (uint32_t)(uintptr_t)&m68k_ptr[-*ext_words]), m68k_ptr - *ext_words);
+                kprintf("Load form EA: Dn with wrong operand size! Opcode %04x at %08x\n", M68K_FetchWord((uint32_t)(uintptr_t)&m68k_ptr[-*ext_words]), m68k_ptr - *ext_words);
                 break;
             default:
                 kprintf("Wrong size\n");
@@ -601,7 +601,7 @@ uint32_t *EMIT_LoadFromEffectiveAddress(uint32_t *ptr, uint8_t size, uint8_t *ar
                 }
                 break;
             case 0:
-                kprintf("Load form EA: An with wrong operand size! Opcode %04x at %08x\n", cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[-*ext_words]), m68k_ptr - *ext_words);
+                kprintf("Load form EA: An with wrong operand size! Opcode %04x at %08x\n", M68K_FetchWord((uintptr_t)&m68k_ptr[-*ext_words]), m68k_ptr - *ext_words);
                 {
                     uint16_t *ptr = &m68k_ptr[-*ext_words] - 8;
                     for (int i=0; i < 16; i++)
@@ -757,19 +757,19 @@ uint32_t *EMIT_LoadFromEffectiveAddress(uint32_t *ptr, uint8_t size, uint8_t *ar
             {
                 RA_FreeARMRegister(&ptr, *arm_reg);
                 *arm_reg = RA_MapM68kRegister(&ptr, src_reg + 8);
-                *imm_offset = (int16_t)cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
+                *imm_offset = (int16_t)M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
             }
             else
             {
                 uint8_t reg_An = RA_MapM68kRegister(&ptr, src_reg + 8);
-                int16_t off16 = (int16_t)cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
+                int16_t off16 = (int16_t)M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
 
                 ptr = load_reg_from_addr_offset(ptr, size, reg_An, *arm_reg, off16, 0, sign_ext);
             }
         }
         else if (mode == 6) /* Mode 006: (d8, An, Xn.SIZE*SCALE) */
         {
-            uint16_t brief = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
+            uint16_t brief = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
             uint8_t extra_reg = (brief >> 12) & 7;
 
             if ((brief & 0x0100) == 0)
@@ -867,13 +867,13 @@ uint32_t *EMIT_LoadFromEffectiveAddress(uint32_t *ptr, uint8_t size, uint8_t *ar
                 {
                     case 2: /* Word displacement */
                         bd_reg = RA_AllocARMRegister(&ptr);
-                        lo16 = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
+                        lo16 = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
                         ptr = load_s16_ext32(ptr, bd_reg, lo16);
                         break;
                     case 3: /* Long displacement */
                         bd_reg = RA_AllocARMRegister(&ptr);
-                        hi16 = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
-                        lo16 = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
+                        hi16 = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
+                        lo16 = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
                         *ptr++ = movw_immed_u16(bd_reg, lo16);
                         if (hi16 != 0)
                             *ptr++ = movt_immed_u16(bd_reg, hi16);
@@ -885,13 +885,13 @@ uint32_t *EMIT_LoadFromEffectiveAddress(uint32_t *ptr, uint8_t size, uint8_t *ar
                 {
                     case 2: /* Word outer displacement */
                         outer_reg = RA_AllocARMRegister(&ptr);
-                        lo16 = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
+                        lo16 = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
                         ptr = load_s16_ext32(ptr, outer_reg, lo16);
                         break;
                     case 3: /* Long outer displacement */
                         outer_reg = RA_AllocARMRegister(&ptr);
-                        hi16 = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
-                        lo16 = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
+                        hi16 = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
+                        lo16 = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
                         *ptr++ = movw_immed_u16(outer_reg, lo16);
                         if (hi16 != 0)
                             *ptr++ = movt_immed_u16(outer_reg, hi16);
@@ -987,20 +987,20 @@ uint32_t *EMIT_LoadFromEffectiveAddress(uint32_t *ptr, uint8_t size, uint8_t *ar
                     ptr = EMIT_GetOffsetPC(ptr, &off8);
                     RA_FreeARMRegister(&ptr, *arm_reg);
                     *arm_reg = REG_PC;
-                    *imm_offset = off8 + (int16_t)cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
+                    *imm_offset = off8 + (int16_t)M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
                 }
                 else
                 {
                     int8_t off8 = 2 + 2*(*ext_words);
                     ptr = EMIT_GetOffsetPC(ptr, &off8);
-                    int32_t off = off8 + (int16_t)(cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]));
+                    int32_t off = off8 + (int16_t)(M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]));
 
                     ptr = load_reg_from_addr_offset(ptr, size, REG_PC, *arm_reg, off, 1, sign_ext);
                 }
             }
             else if (src_reg == 3)
             {
-                uint16_t brief = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
+                uint16_t brief = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
                 uint8_t extra_reg = (brief >> 12) & 7;
 
                 if ((brief & 0x0100) == 0)
@@ -1235,7 +1235,7 @@ uint32_t *EMIT_LoadFromEffectiveAddress(uint32_t *ptr, uint8_t size, uint8_t *ar
             else if (src_reg == 0)
             {
                 uint16_t lo16;
-                lo16 = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
+                lo16 = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
 
                 if (size == 0) {
                     ptr = load_s16_ext32(ptr, *arm_reg, lo16);
@@ -1251,8 +1251,8 @@ uint32_t *EMIT_LoadFromEffectiveAddress(uint32_t *ptr, uint8_t size, uint8_t *ar
             else if (src_reg == 1)
             {
                 uint16_t hi16, lo16;
-                hi16 = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
-                lo16 = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
+                hi16 = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
+                lo16 = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
 
                 if (size == 0) {
                     if (lo16 == 0 && hi16 == 0)
@@ -1317,8 +1317,8 @@ uint32_t *EMIT_LoadFromEffectiveAddress(uint32_t *ptr, uint8_t size, uint8_t *ar
                 switch (size)
                 {
                     case 4:
-                        hi16 = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
-                        lo16 = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
+                        hi16 = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
+                        lo16 = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
 
                         if (lo16 == 0 && hi16 == 0)
                         {
@@ -1336,7 +1336,7 @@ uint32_t *EMIT_LoadFromEffectiveAddress(uint32_t *ptr, uint8_t size, uint8_t *ar
                         }
                         break;
                     case 2:
-                        off = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
+                        off = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
 
                         if (sign_ext && (off & 0x8000))
                             *ptr++ = movn_immed_u16(*arm_reg, ~off, 0);
@@ -1344,7 +1344,7 @@ uint32_t *EMIT_LoadFromEffectiveAddress(uint32_t *ptr, uint8_t size, uint8_t *ar
                             *ptr++ = mov_immed_u16(*arm_reg, off, 0);
                         break;
                     case 1:
-                        off = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]) & 0xff;
+                        off = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]) & 0xff;
                         if (sign_ext && (off & 0x80))
                             *ptr++ = movn_immed_u16(*arm_reg, ~(off | 0xff00), 0);
                         else
@@ -1545,13 +1545,13 @@ uint32_t *EMIT_StoreToEffectiveAddress(uint32_t *ptr, uint8_t size, uint8_t *arm
         else if (mode == 5) /* Mode 005: (d16, An) */
         {
             uint8_t reg_An = RA_MapM68kRegister(&ptr, src_reg + 8);
-            int16_t off16 = (int16_t)cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
+            int16_t off16 = (int16_t)M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
 
             ptr = store_reg_to_addr_offset(ptr, size, reg_An, *arm_reg, off16, 0);
         }
         else if (mode == 6) /* Mode 006: (d8, An, Xn.SIZE*SCALE) */
         {
-            uint16_t brief = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
+            uint16_t brief = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
             uint8_t extra_reg = (brief >> 12) & 7;
 
             if ((brief & 0x0100) == 0)
@@ -1645,13 +1645,13 @@ uint32_t *EMIT_StoreToEffectiveAddress(uint32_t *ptr, uint8_t size, uint8_t *arm
                 {
                     case 2: /* Word displacement */
                         bd_reg = RA_AllocARMRegister(&ptr);
-                        lo16 = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
+                        lo16 = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
                         ptr = load_s16_ext32(ptr, bd_reg, lo16);
                         break;
                     case 3: /* Long displacement */
                         bd_reg = RA_AllocARMRegister(&ptr);
-                        hi16 = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
-                        lo16 = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
+                        hi16 = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
+                        lo16 = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
                         *ptr++ = movw_immed_u16(bd_reg, lo16);
                         if (hi16)
                             *ptr++ = movt_immed_u16(bd_reg, hi16);
@@ -1663,13 +1663,13 @@ uint32_t *EMIT_StoreToEffectiveAddress(uint32_t *ptr, uint8_t size, uint8_t *arm
                 {
                     case 2: /* Word outer displacement */
                         outer_reg = RA_AllocARMRegister(&ptr);
-                        lo16 = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
+                        lo16 = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
                         ptr = load_s16_ext32(ptr, outer_reg, lo16);
                         break;
                     case 3: /* Long outer displacement */
                         outer_reg = RA_AllocARMRegister(&ptr);
-                        hi16 = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
-                        lo16 = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
+                        hi16 = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
+                        lo16 = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
                         *ptr++ = movw_immed_u16(outer_reg, lo16);
                         if (hi16)
                             *ptr++ = movt_immed_u16(outer_reg, hi16);
@@ -1771,7 +1771,7 @@ uint32_t *EMIT_StoreToEffectiveAddress(uint32_t *ptr, uint8_t size, uint8_t *arm
             if (src_reg == 2) /* (d16, PC) mode */
             {
                 int8_t off = 2;
-                int32_t off32 = (int16_t)cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
+                int32_t off32 = (int16_t)M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
                 ptr = EMIT_GetOffsetPC(ptr, &off);
                 off32 += off;
 
@@ -1779,7 +1779,7 @@ uint32_t *EMIT_StoreToEffectiveAddress(uint32_t *ptr, uint8_t size, uint8_t *arm
             }
             else if (src_reg == 3)
             {
-                uint16_t brief = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
+                uint16_t brief = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
                 uint8_t extra_reg = (brief >> 12) & 7;
 
                 if ((brief & 0x0100) == 0)
@@ -1886,13 +1886,13 @@ uint32_t *EMIT_StoreToEffectiveAddress(uint32_t *ptr, uint8_t size, uint8_t *arm
                     {
                         case 2: /* Word displacement */
                             bd_reg = RA_AllocARMRegister(&ptr);
-                            lo16 = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
+                            lo16 = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
                             ptr = load_s16_ext32(ptr, bd_reg, lo16);
                             break;
                         case 3: /* Long displacement */
                             bd_reg = RA_AllocARMRegister(&ptr);
-                            hi16 = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
-                            lo16 = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
+                            hi16 = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
+                            lo16 = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
                             *ptr++ = movw_immed_u16(bd_reg, lo16);
                             if (hi16)
                                 *ptr++ = movt_immed_u16(bd_reg, hi16);
@@ -1904,13 +1904,13 @@ uint32_t *EMIT_StoreToEffectiveAddress(uint32_t *ptr, uint8_t size, uint8_t *arm
                     {
                         case 2: /* Word outer displacement */
                             outer_reg = RA_AllocARMRegister(&ptr);
-                            lo16 = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
+                            lo16 = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
                             ptr = load_s16_ext32(ptr, outer_reg, lo16);
                             break;
                         case 3: /* Long outer displacement */
                             outer_reg = RA_AllocARMRegister(&ptr);
-                            hi16 = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
-                            lo16 = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
+                            hi16 = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
+                            lo16 = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
                             *ptr++ = movw_immed_u16(outer_reg, lo16);
                             if (hi16)
                                 *ptr++ = movt_immed_u16(outer_reg, hi16);
@@ -1997,7 +1997,7 @@ uint32_t *EMIT_StoreToEffectiveAddress(uint32_t *ptr, uint8_t size, uint8_t *arm
             else if (src_reg == 0)
             {
                 uint16_t lo16;
-                lo16 = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
+                lo16 = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
 
                 if (size == 0) {
                     ptr = load_s16_ext32(ptr, *arm_reg, lo16);
@@ -2013,8 +2013,8 @@ uint32_t *EMIT_StoreToEffectiveAddress(uint32_t *ptr, uint8_t size, uint8_t *arm
             else if (src_reg == 1)
             {
                 uint16_t lo16, hi16;
-                hi16 = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
-                lo16 = cache_read_16(ICACHE, (uintptr_t)&m68k_ptr[(*ext_words)++]);
+                hi16 = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
+                lo16 = M68K_FetchWord((uintptr_t)&m68k_ptr[(*ext_words)++]);
 
                 if (size == 0) {
                     if (lo16 == 0 && hi16 == 0)
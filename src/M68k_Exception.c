@@ -110,6 +110,9 @@ uint32_t *EMIT_Exception(uint32_t *ptr, uint16_t exception, uint8_t format, ...)
     *ptr++ = bic_immed(cc, cc, 2, 32 - SRB_T0);
     *ptr++ = orr_immed(cc, cc, 1, 32 - SRB_S);
 
+    /* Exception frame breaks the call/return pairing, forget remembered return addresses */
+    ptr = EMIT_ResetReturnStack(ptr, ctx);
+
     /* Load VBR */
     *ptr++ = ldr_offset(ctx, vbr, __builtin_offsetof(struct M68KState, VBR));
     *ptr++ = ldr_offset(vbr, REG_PC, exception);
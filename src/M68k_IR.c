@@ -0,0 +1,409 @@
+/*
+    Copyright © 2019 Michal Schulz <michal.schulz@gmx.de>
+    https://github.com/michalsc
+
+    This Source Code Form is subject to the terms of the
+    Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed
+    with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "support.h"
+#include "M68k.h"
+#include "RegisterAllocator.h"
+
+/*
+    Lightweight intermediate representation of the straight line code decoded by M68K_DecodeUnit.
+
+    Every m68k instruction becomes one op on the fixed m68k register file. Only register moves, immediate
+    loads and address arithmetic are modelled, everything else is an opaque op which reads and writes
+    all registers. Values of registers are tracked symbolically as either a constant or a version of
+    some register plus an offset, so that constants and addresses propagate through the code.
+
+    Two passes run over the ops:
+     - forward pass drops ops which write a value the destination register holds already (repeated
+       LEA, MOVEQ, MOVEA of constants or of the same address), and rewrites register moves and
+       address arithmetic with a constant result into immediate loads,
+     - backward pass drops writes to Dn/An, including byte and word writes to Dn, overwritten by
+       a later op before being read.
+
+    Lowering is done by the translator. Dropped ops emit no A64 code, rewritten ones are emitted by
+    M68K_IRLower as a load of the immediate, remaining ones go through the direct emitters.
+*/
+
+enum {
+    IR_OPAQUE,
+    IR_CONST,       /* Rd = value */
+    IR_PARTIAL,     /* Low byte or word of Dd = value */
+    IR_COPY,        /* Rd = Rs */
+    IR_ADDR,        /* Rd = Rs + value */
+};
+
+enum {
+    IR_KEEP,
+    IR_DROP,
+    IR_LOWER,       /* Emit as Rd = value, the source register is not read */
+};
+
+struct IROp {
+    uint8_t     ir_Kind;
+    uint8_t     ir_Action;
+    uint8_t     ir_Dst;
+    uint8_t     ir_Src;
+    uint8_t     ir_Size;
+    uint8_t     ir_Join;        /* Code can be entered here by a branch */
+    int16_t     ir_KilledBy;    /* Op overwriting result of the dropped store */
+    uint32_t    ir_Value;
+};
+
+/* Symbolic register value: version of base register plus offset. Base 0xff means constant */
+struct IRValue {
+    uint8_t     iv_Base;
+    uint32_t    iv_Version;
+    uint32_t    iv_Offset;
+};
+
+#define IR_CONSTANT 0xff
+
+static struct IROp ir_ops[JCCB_INSN_DEPTH_MASK + 1 + JC2_CCR_SCAN_MASK + 1];
+static int ir_count;
+/* Next instruction the translator has to emit for the decisions of the passes to stay valid */
+static uint16_t *ir_next;
+
+static void IR_Classify(struct IROp *op, struct DecodedInsn *insn)
+{
+    uint16_t opcode = M68K_FetchWord((uint32_t)(uintptr_t)insn->di_Insn);
+    uint32_t ext = (uint32_t)(uintptr_t)&insn->di_Insn[1];
+
+    op->ir_Kind = IR_OPAQUE;
+    op->ir_Action = IR_KEEP;
+    op->ir_KilledBy = -1;
+
+    /* MOVEQ #imm, Dn */
+    if ((opcode & 0xf100) == 0x7000)
+    {
+        op->ir_Kind = IR_CONST;
+        op->ir_Dst = (opcode >> 9) & 7;
+        op->ir_Value = (int8_t)(opcode & 0xff);
+    }
+    /* MOVE.L #imm, Dn and MOVEA.L #imm, An */
+    else if ((opcode & 0xf1bf) == 0x203c)
+    {
+        op->ir_Kind = IR_CONST;
+        op->ir_Dst = ((opcode >> 9) & 7) + ((opcode & 0x40) ? 8 : 0);
+        op->ir_Value = M68K_FetchLong(ext);
+    }
+    /* MOVEA.W #imm, An */
+    else if ((opcode & 0xf1ff) == 0x307c)
+    {
+        op->ir_Kind = IR_CONST;
+        op->ir_Dst = 8 + ((opcode >> 9) & 7);
+        op->ir_Value = (int16_t)M68K_FetchWord(ext);
+    }
+    /* MOVE.W #imm, Dn and MOVE.B #imm, Dn */
+    else if ((opcode & 0xf1ff) == 0x303c || (opcode & 0xf1ff) == 0x103c)
+    {
+        op->ir_Kind = IR_PARTIAL;
+        op->ir_Dst = (opcode >> 9) & 7;
+        op->ir_Size = (opcode & 0x2000) ? 2 : 1;
+        op->ir_Value = M68K_FetchWord(ext) & (op->ir_Size == 2 ? 0xffff : 0xff);
+    }
+    /* MOVE.L Rs, Dn and MOVEA.L Rs, An */
+    else if ((opcode & 0xf1b0) == 0x2000)
+    {
+        op->ir_Kind = IR_COPY;
+        op->ir_Dst = ((opcode >> 9) & 7) + ((opcode & 0x40) ? 8 : 0);
+        op->ir_Src = opcode & 15;
+    }
+    /* LEA */
+    else if ((opcode & 0xf1c0) == 0x41c0)
+    {
+        uint8_t mode = (opcode >> 3) & 7;
+        uint8_t dst = 8 + ((opcode >> 9) & 7);
+
+        if (mode == 2)
+        {
+            op->ir_Kind = IR_COPY;
+            op->ir_Dst = dst;
+            op->ir_Src = 8 + (opcode & 7);
+        }
+        else if (mode == 5)
+        {
+            op->ir_Kind = IR_ADDR;
+            op->ir_Dst = dst;
+            op->ir_Src = 8 + (opcode & 7);
+            op->ir_Value = (int16_t)M68K_FetchWord(ext);
+        }
+        else if ((opcode & 0x3f) == 0x38)
+        {
+            op->ir_Kind = IR_CONST;
+            op->ir_Dst = dst;
+            op->ir_Value = (int16_t)M68K_FetchWord(ext);
+        }
+        else if ((opcode & 0x3f) == 0x39)
+        {
+            op->ir_Kind = IR_CONST;
+            op->ir_Dst = dst;
+            op->ir_Value = M68K_FetchLong(ext);
+        }
+    }
+    /* ADDQ/SUBQ #imm, An, word and long alike */
+    else if ((opcode & 0xf0f8) == 0x5048 || (opcode & 0xf0f8) == 0x5088)
+    {
+        uint32_t q = (opcode >> 9) & 7;
+
+        if (q == 0)
+            q = 8;
+
+        op->ir_Kind = IR_ADDR;
+        op->ir_Dst = 8 + (opcode & 7);
+        op->ir_Src = op->ir_Dst;
+        op->ir_Value = (opcode & 0x0100) ? -q : q;
+    }
+}
+
+static inline int IR_SameValue(struct IRValue *a, struct IRValue *b)
+{
+    return a->iv_Base == b->iv_Base && a->iv_Offset == b->iv_Offset &&
+           (a->iv_Base == IR_CONSTANT || a->iv_Version == b->iv_Version);
+}
+
+/* Forward pass. Propagate constants and addresses, drop ops which do not change the destination */
+static void IR_PropagateValues()
+{
+    struct IRValue values[16];
+    uint32_t version = 0;
+
+    for (int r=0; r < 16; r++)
+        values[r] = (struct IRValue){ r, version++, 0 };
+
+    for (int i=0; i < ir_count; i++)
+    {
+        struct IROp *op = &ir_ops[i];
+        struct DecodedInsn *insn = M68K_GetDecodedInsn(i);
+        struct IRValue v;
+
+        /* Nothing is known about registers at a branch target */
+        if (op->ir_Join)
+        {
+            for (int r=0; r < 16; r++)
+                values[r] = (struct IRValue){ r, version++, 0 };
+        }
+
+        switch (op->ir_Kind)
+        {
+            case IR_CONST:
+                v = (struct IRValue){ IR_CONSTANT, 0, op->ir_Value };
+                break;
+
+            case IR_PARTIAL:
+                if (values[op->ir_Dst].iv_Base == IR_CONSTANT)
+                {
+                    uint32_t mask = op->ir_Size == 2 ? 0xffff : 0xff;
+                    v = (struct IRValue){ IR_CONSTANT, 0, (values[op->ir_Dst].iv_Offset & ~mask) | op->ir_Value };
+                }
+                else
+                    v = (struct IRValue){ op->ir_Dst, version++, 0 };
+                break;
+
+            case IR_COPY:
+                v = values[op->ir_Src];
+                break;
+
+            case IR_ADDR:
+                v = values[op->ir_Src];
+                v.iv_Offset += op->ir_Value;
+                break;
+
+            default:
+                for (int r=0; r < 16; r++)
+                    values[r] = (struct IRValue){ r, version++, 0 };
+                continue;
+        }
+
+        /* Destination holds the value already and flags set by the op are not needed */
+        if (IR_SameValue(&values[op->ir_Dst], &v) && (insn->di_Sets & insn->di_LiveOut) == 0)
+            op->ir_Action = IR_DROP;
+        /* Result is a known constant. Load it as immediate, unless flags of MOVE to Dn are needed */
+        else if ((op->ir_Kind == IR_COPY || op->ir_Kind == IR_ADDR) && v.iv_Base == IR_CONSTANT &&
+                 (op->ir_Dst >= 8 || (insn->di_Sets & insn->di_LiveOut) == 0))
+        {
+            op->ir_Kind = IR_CONST;
+            op->ir_Action = IR_LOWER;
+            op->ir_Value = v.iv_Offset;
+        }
+
+        values[op->ir_Dst] = v;
+    }
+}
+
+/* Widths of register writes: byte, word and long */
+#define IR_WIDTHS   3
+
+/*
+    Backward pass. Drop stores to registers which are overwritten by a later op before being read.
+    Byte or word write to Dn is overwritten by a later write of the same or larger width, while it
+    reads the upper part of the register and therefore keeps wider writes before it alive.
+*/
+static void IR_EliminateDeadStores()
+{
+    /* Nearest later op writing at least the byte, word or long of the register before it is read */
+    int16_t next_write[16][IR_WIDTHS];
+
+    for (int r=0; r < 16; r++)
+        for (int w=0; w < IR_WIDTHS; w++)
+            next_write[r][w] = -1;
+
+    for (int i=ir_count - 1; i >= 0; --i)
+    {
+        struct IROp *op = &ir_ops[i];
+        struct DecodedInsn *insn = M68K_GetDecodedInsn(i);
+        int reads_dst = (op->ir_Kind == IR_COPY || op->ir_Kind == IR_ADDR) && op->ir_Src == op->ir_Dst;
+        int width = op->ir_Kind == IR_PARTIAL ? op->ir_Size - 1 : IR_WIDTHS - 1;
+
+        if (op->ir_Kind == IR_OPAQUE)
+        {
+            for (int r=0; r < 16; r++)
+                for (int w=0; w < IR_WIDTHS; w++)
+                    next_write[r][w] = -1;
+            continue;
+        }
+
+        if (op->ir_Action != IR_DROP && !reads_dst && next_write[op->ir_Dst][width] >= 0 &&
+            (insn->di_Sets & insn->di_LiveOut) == 0)
+        {
+            op->ir_Action = IR_DROP;
+            op->ir_KilledBy = next_write[op->ir_Dst][width];
+        }
+
+        /* Only ops which stay in the code can overwrite the register */
+        if (!reads_dst && op->ir_Action != IR_DROP)
+        {
+            for (int w=0; w <= width; w++)
+                next_write[op->ir_Dst][w] = i;
+        }
+        for (int w=width + 1; w < IR_WIDTHS; w++)
+            next_write[op->ir_Dst][w] = -1;
+        if (op->ir_Kind == IR_COPY || op->ir_Kind == IR_ADDR)
+        {
+            for (int w=0; w < IR_WIDTHS; w++)
+                next_write[op->ir_Src][w] = -1;
+        }
+
+        /* Do not look across branch targets */
+        if (op->ir_Join)
+        {
+            for (int r=0; r < 16; r++)
+                for (int w=0; w < IR_WIDTHS; w++)
+                    next_write[r][w] = -1;
+        }
+    }
+}
+
+void M68K_BuildIR()
+{
+    ir_count = M68K_GetDecodedCount();
+
+    for (int i=0; i < ir_count; i++)
+    {
+        ir_ops[i].ir_Join = 0;
+        IR_Classify(&ir_ops[i], M68K_GetDecodedInsn(i));
+    }
+
+    for (int i=0; i < ir_count; i++)
+    {
+        struct DecodedInsn *insn = M68K_GetDecodedInsn(i);
+
+        if (insn->di_TargetIdx >= 0)
+            ir_ops[insn->di_TargetIdx].ir_Join = 1;
+    }
+
+    IR_PropagateValues();
+    IR_EliminateDeadStores();
+
+    ir_next = ir_count ? M68K_GetDecodedInsn(0)->di_Insn : NULL;
+}
+
+/*
+    Returns the number of m68k words of the instruction at insn_stream if the passes dropped it,
+    0 if it has to be emitted. The decision holds only if the translator followed the decoded code
+    from the entry of the unit, and for dropped stores if the overwriting op is translated within
+    remaining insn_budget instructions.
+*/
+int M68K_IRSkip(uint16_t *insn_stream, int insn_budget)
+{
+    int idx;
+
+    if (insn_stream != ir_next)
+        return 0;
+
+    idx = M68K_FindDecodedInsn(insn_stream);
+
+    if (idx < 0 || ir_ops[idx].ir_Action != IR_DROP)
+        return 0;
+
+    if (ir_ops[idx].ir_KilledBy >= 0 && ir_ops[idx].ir_KilledBy - idx >= insn_budget)
+        return 0;
+
+    return M68K_GetDecodedInsn(idx)->di_Length;
+}
+
+/*
+    Emit the instruction at *m68k_ptr as load of the immediate found by the forward pass and advance
+    *m68k_ptr past it. Returns NULL if the instruction has to be translated as usual. Like dropping,
+    the rewrite holds only if the translator followed the decoded code from the entry of the unit.
+*/
+uint32_t *M68K_IRLower(uint32_t *ptr, uint16_t **m68k_ptr)
+{
+    struct IROp *op;
+    uint8_t reg;
+    int idx;
+
+    if (*m68k_ptr != ir_next)
+        return NULL;
+
+    idx = M68K_FindDecodedInsn(*m68k_ptr);
+
+    if (idx < 0 || ir_ops[idx].ir_Action != IR_LOWER)
+        return NULL;
+
+    op = &ir_ops[idx];
+    reg = RA_MapM68kRegisterForWrite(&ptr, op->ir_Dst);
+
+    if ((op->ir_Value & 0xffff0000) == 0xffff0000)
+        *ptr++ = movn_immed_u16(reg, ~op->ir_Value & 0xffff, 0);
+    else
+    {
+        *ptr++ = movw_immed_u16(reg, op->ir_Value & 0xffff);
+        if (op->ir_Value >> 16)
+            *ptr++ = movt_immed_u16(reg, op->ir_Value >> 16);
+    }
+
+    ptr = EMIT_AdvancePC(ptr, 2 * M68K_GetDecodedInsn(idx)->di_Length);
+    *m68k_ptr += M68K_GetDecodedInsn(idx)->di_Length;
+
+    return ptr;
+}
+
+/* Follow the translator. The chain breaks on branches or once code is left out of order */
+void M68K_IRAdvance(uint16_t *insn_stream, uint16_t *next)
+{
+    int idx = M68K_FindDecodedInsn(insn_stream);
+    int next_idx = M68K_FindDecodedInsn(next);
+
+    if (insn_stream != ir_next || idx < 0 || next_idx <= idx)
+    {
+        ir_next = NULL;
+        return;
+    }
+
+    for (int i=idx; i < next_idx; i++)
+    {
+        if (M68K_GetDecodedInsn(i)->di_Branch)
+        {
+            ir_next = NULL;
+            return;
+        }
+    }
+
+    ir_next = next;
+}
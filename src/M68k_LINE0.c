@@ -27,18 +27,18 @@ uint32_t *EMIT_CMPI(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
     switch (opcode & 0x00c0)
     {
         case 0x0000:    /* Byte operation */
-            lo16 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[ext_count++]);
+            lo16 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[ext_count++]);
             *ptr++ = mov_immed_u16(immed, (lo16 & 0xff) << 8, 1);
             size = 1;
             break;
         case 0x0040:    /* Short operation */
-            lo16 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[ext_count++]);
+            lo16 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[ext_count++]);
             *ptr++ = mov_immed_u16(immed, lo16, 1);
             size = 2;
             break;
         case 0x0080:    /* Long operation */
-            u32 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[ext_count++]) << 16;
-            u32 |= cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[ext_count++]);
+            u32 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[ext_count++]) << 16;
+            u32 |= M68K_FetchWord((uintptr_t)&(*m68k_ptr)[ext_count++]);
             if (u32 < 4096)
             {
                 immediate = 1;
@@ -117,6 +117,8 @@ uint32_t *EMIT_CMPI(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
     ptr = EMIT_AdvancePC(ptr, 2 * (ext_count + 1));
     (*m68k_ptr) += ext_count;
 
+    update_mask = RA_DeferCC(LAZY_CC_NZnCV, update_mask);
+
     if (update_mask)
     {
         uint8_t cc = RA_ModifyCC(&ptr);
@@ -149,22 +151,22 @@ uint32_t *EMIT_SUBI(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
     switch (opcode & 0x00c0)
     {
         case 0x0000:    /* Byte operation */
-            lo16 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[ext_count++]) & 0xff;
+            lo16 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[ext_count++]) & 0xff;
             if (!(update_mask == 0)) {
                 *ptr++ = mov_immed_u16(immed, lo16 << 8, 1);
             }
             size = 1;
             break;
         case 0x0040:    /* Short operation */
-            lo16 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[ext_count++]);
+            lo16 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[ext_count++]);
             if (!(update_mask == 0)) {
                 *ptr++ = mov_immed_u16(immed, lo16, 1);
             }
             size = 2;
             break;
         case 0x0080:    /* Long operation */
-            u32 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[ext_count++]) << 16;
-            u32 |= cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[ext_count++]);
+            u32 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[ext_count++]) << 16;
+            u32 |= M68K_FetchWord((uintptr_t)&(*m68k_ptr)[ext_count++]);
             if (u32 < 4096)
             {
                 immediate = 1;
@@ -410,22 +412,22 @@ uint32_t *EMIT_ADDI(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
     switch (opcode & 0x00c0)
     {
         case 0x0000:    /* Byte operation */
-            lo16 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[ext_count++]) & 0xff;
+            lo16 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[ext_count++]) & 0xff;
             if (!(update_mask == 0)) {
                 *ptr++ = mov_immed_u16(immed, (lo16 & 0xff) << 8, 1);
             }
             size = 1;
             break;
         case 0x0040:    /* Short operation */
-            lo16 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[ext_count++]);
+            lo16 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[ext_count++]);
             if (!(update_mask == 0)) {
                 *ptr++ = mov_immed_u16(immed, lo16, 1);
             }
             size = 2;
             break;
         case 0x0080:    /* Long operation */
-            u32 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[ext_count++]) << 16;
-            u32 |= cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[ext_count++]);
+            u32 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[ext_count++]) << 16;
+            u32 |= M68K_FetchWord((uintptr_t)&(*m68k_ptr)[ext_count++]);
             if (u32 < 4096)
             {
                 add_immediate = 1;
@@ -657,7 +659,7 @@ uint32_t *EMIT_ORI_TO_CCR(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
 {
     (void)opcode;
     uint8_t immed = RA_AllocARMRegister(&ptr);
-    uint16_t val8 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr[0]));
+    uint16_t val8 = M68K_FetchWord((uintptr_t)&(*m68k_ptr[0]));
 
     /* Swap C and V flags in immediate */
     if ((val8 & 3) != 0 && (val8 & 3) < 3)
@@ -683,7 +685,7 @@ uint32_t *EMIT_ORI_TO_SR(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
     (void)opcode;
     uint8_t immed = RA_AllocARMRegister(&ptr);
     uint8_t changed = RA_AllocARMRegister(&ptr);
-    int16_t val = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    int16_t val = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     uint8_t sp = RA_MapM68kRegister(&ptr, 15);
     uint32_t *tmp;
     RA_SetDirtyM68kRegister(&ptr, 15);
@@ -770,7 +772,7 @@ uint32_t *EMIT_ORI(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
     switch (opcode & 0x00c0)
     {
         case 0x0000:    /* Byte operation */
-            lo16 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[ext_count++]) & 0xff;
+            lo16 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[ext_count++]) & 0xff;
             if (update_mask == 0) {
                 mask32 = number_to_mask(lo16);
                 if (mask32 == 0 || mask32 == 0xffffffff) {
@@ -784,7 +786,7 @@ uint32_t *EMIT_ORI(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
             size = 1;
             break;
         case 0x0040:    /* Short operation */
-            lo16 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[ext_count++]);
+            lo16 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[ext_count++]);
             if (update_mask == 0) {
                 mask32 = number_to_mask(lo16 & 0xffff);
                 if (mask32 == 0 || mask32 == 0xffffffff) {
@@ -798,8 +800,8 @@ uint32_t *EMIT_ORI(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
             size = 2;
             break;
         case 0x0080:    /* Long operation */
-            u32 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[ext_count++]) << 16;
-            u32 |= cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[ext_count++]);
+            u32 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[ext_count++]) << 16;
+            u32 |= M68K_FetchWord((uintptr_t)&(*m68k_ptr)[ext_count++]);
             mask32 = number_to_mask(u32);
             if (mask32 == 0 || mask32 == 0xffffffff)
             {
@@ -1030,7 +1032,7 @@ uint32_t *EMIT_ANDI_TO_CCR(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
 {
     (void)opcode;
     uint8_t immed = RA_AllocARMRegister(&ptr);
-    uint16_t val = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t val = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
    
     /* Swap C and V flags in immediate */
     if ((val & 3) != 0 && (val & 3) < 3)
@@ -1053,7 +1055,7 @@ uint32_t *EMIT_ANDI_TO_SR(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
 {
     (void)opcode;
     uint8_t immed = RA_AllocARMRegister(&ptr);
-    int16_t val = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    int16_t val = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     uint32_t *tmp;
 
     uint8_t changed = RA_AllocARMRegister(&ptr);
@@ -1147,7 +1149,7 @@ uint32_t *EMIT_ANDI(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
     switch (opcode & 0x00c0)
     {
         case 0x0000:    /* Byte operation */
-            lo16 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[ext_count++]) & 0xff;
+            lo16 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[ext_count++]) & 0xff;
             if (update_mask == 0) {
                 if ((opcode & 0x0038) == 0) {
                     if (lo16 != 0xff) {
@@ -1173,7 +1175,7 @@ uint32_t *EMIT_ANDI(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
             size = 1;
             break;
         case 0x0040:    /* Short operation */
-            lo16 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[ext_count++]);
+            lo16 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[ext_count++]);
             if (update_mask == 0) {
                 if ((opcode & 0x0038) == 0) {
                     if (lo16 != 0xffff) 
@@ -1199,8 +1201,8 @@ uint32_t *EMIT_ANDI(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
             size = 2;
             break;
         case 0x0080:    /* Long operation */
-            u32 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[ext_count++]) << 16;
-            u32 |= cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[ext_count++]);
+            u32 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[ext_count++]) << 16;
+            u32 |= M68K_FetchWord((uintptr_t)&(*m68k_ptr)[ext_count++]);
             mask32 = number_to_mask(u32);
             if (mask32 == 0 || mask32 == 0xffffffff)
             {
@@ -1384,7 +1386,7 @@ uint32_t *EMIT_EORI_TO_CCR(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
 {
     (void)opcode;
     uint8_t immed = RA_AllocARMRegister(&ptr);
-    int16_t val = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    int16_t val = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
 
     /* Swap C and V flags in immediate */
     if ((val & 3) != 0 && (val & 3) < 3)
@@ -1407,7 +1409,7 @@ uint32_t *EMIT_EORI_TO_SR(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
 {
     (void)opcode;
     uint8_t immed = RA_AllocARMRegister(&ptr);
-    int16_t val = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    int16_t val = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     uint32_t *tmp;
 
     uint8_t orig = RA_AllocARMRegister(&ptr);
@@ -1497,18 +1499,18 @@ uint32_t *EMIT_EORI(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
     switch (opcode & 0x00c0)
     {
         case 0x0000:    /* Byte operation */
-            lo16 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[ext_count++]);
+            lo16 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[ext_count++]);
             *ptr++ = mov_immed_u16(immed, (lo16 & 0xff) << 8, 1);
             size = 1;
             break;
         case 0x0040:    /* Short operation */
-            lo16 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[ext_count++]);
+            lo16 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[ext_count++]);
             *ptr++ = mov_immed_u16(immed, lo16, 1);
             size = 2;
             break;
         case 0x0080:    /* Long operation */
-            u32 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[ext_count++]) << 16;
-            u32 |= cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[ext_count++]);
+            u32 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[ext_count++]) << 16;
+            u32 |= M68K_FetchWord((uintptr_t)&(*m68k_ptr)[ext_count++]);
             mask32 = number_to_mask(u32);
             if (mask32 == 0 || mask32 == 0xffffffff)
             {
@@ -1687,7 +1689,7 @@ uint32_t *EMIT_BTST(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
     if ((opcode & 0xffc0) == 0x0800)
     {
         immediate = 1;
-        imm_shift = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[ext_count++]) & 31;
+        imm_shift = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[ext_count++]) & 31;
     }
     else
     {
@@ -1768,7 +1770,7 @@ uint32_t *EMIT_BCHG(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
     if ((opcode & 0xffc0) == 0x0840)
     {
         immediate = 1;
-        imm_shift = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[ext_count++]) & 31;
+        imm_shift = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[ext_count++]) & 31;
     }
     else
     {
@@ -1884,7 +1886,7 @@ uint32_t *EMIT_BCLR(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
     if ((opcode & 0xffc0) == 0x0880)
     {
         immediate = 1;
-        imm_shift = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[ext_count++]) & 31;
+        imm_shift = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[ext_count++]) & 31;
     }
     else
     {
@@ -1990,7 +1992,7 @@ uint32_t *EMIT_CMP2(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
     uint32_t opcode_address = (uint32_t)(uintptr_t)((*m68k_ptr) - 1);
     uint8_t update_mask = SR_Z | SR_C;
     uint8_t ext_words = 1;
-    uint16_t opcode2 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode2 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     uint8_t ea = -1;
     uint8_t lower = RA_AllocARMRegister(&ptr);
     uint8_t higher = RA_AllocARMRegister(&ptr);
@@ -2086,14 +2088,13 @@ uint32_t *EMIT_CMP2(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
     /* If CHK2 opcode then emit exception if tested value was out of range (C flag set) */
     if (opcode2 & (1 << 11))
     {
-        /* Flush program counter, since it might be pushed on the stack when
-        exception is generated */
-        ptr = EMIT_FlushPC(ptr);
-
         /* Skip exception if C is not set */
         uint32_t *t = ptr;
         *ptr++ = 0;
 
+        /* Program counter is pushed on the stack, bring it up to date on exception path only */
+        ptr = EMIT_SyncPC(ptr, 0);
+
         /* Emit CHK exception */
         ptr = EMIT_Exception(ptr, VECTOR_CHK, 2, opcode_address);
         *t = tbz(cc, SRB_Calt, ptr - t);
@@ -2121,7 +2122,7 @@ uint32_t *EMIT_BSET(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
     if ((opcode & 0xffc0) == 0x08c0)
     {
         immediate = 1;
-        imm_shift = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[ext_count++]) & 31;
+        imm_shift = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[ext_count++]) & 31;
     }
     else
     {
@@ -2331,8 +2332,8 @@ uint32_t *EMIT_CAS(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
     {
         uint8_t ext_words = 2;
         uint8_t size = (opcode >> 9) & 3;
-        uint16_t opcode2 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
-        uint16_t opcode3 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[1]);
+        uint16_t opcode2 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
+        uint16_t opcode3 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[1]);
 
         uint8_t rn1 = RA_MapM68kRegister(&ptr, (opcode2 >> 12) & 15);
         uint8_t rn2 = RA_MapM68kRegister(&ptr, (opcode3 >> 12) & 15);
@@ -2415,7 +2416,7 @@ uint32_t *EMIT_CAS(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
     else
     {
         uint8_t ext_words = 1;
-        uint16_t opcode2 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+        uint16_t opcode2 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
         uint8_t ea = -1;
         uint8_t du = RA_MapM68kRegister(&ptr, (opcode2 >> 6) & 7);
         uint8_t dc = RA_MapM68kRegister(&ptr, opcode2 & 7);
@@ -2459,13 +2460,13 @@ uint32_t *EMIT_CAS(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
             switch(size)
             {
                 case 2:
-                    if (cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[1]) & 1)
+                    if (M68K_FetchWord((uintptr_t)&(*m68k_ptr)[1]) & 1)
                         CAS_UNSAFE();
                     else
                         CAS_ATOMIC();
                     break;
                 case 3:
-                    if ((cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[1]) & 3) == 0)
+                    if ((M68K_FetchWord((uintptr_t)&(*m68k_ptr)[1]) & 3) == 0)
                         CAS_ATOMIC();
                     else
                         CAS_UNSAFE();
@@ -2477,13 +2478,13 @@ uint32_t *EMIT_CAS(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
             switch(size)
             {
                 case 2:
-                    if (cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[2]) & 1)
+                    if (M68K_FetchWord((uintptr_t)&(*m68k_ptr)[2]) & 1)
                         CAS_UNSAFE();
                     else
                         CAS_ATOMIC();
                     break;
                 case 3:
-                    if ((cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[2]) & 3) == 0)
+                    if ((M68K_FetchWord((uintptr_t)&(*m68k_ptr)[2]) & 3) == 0)
                         CAS_ATOMIC();
                     else
                         CAS_UNSAFE();
@@ -2566,7 +2567,7 @@ uint32_t *EMIT_CAS(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
 
 uint32_t *EMIT_MOVEP(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
 {
-    int32_t offset = (int16_t)cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    int32_t offset = (int16_t)M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     uint8_t an = RA_MapM68kRegister(&ptr, 8 + (opcode & 7));
     uint8_t dn = RA_MapM68kRegister(&ptr, (opcode >> 9) & 7);
     uint8_t tmp = RA_AllocARMRegister(&ptr);
@@ -2674,7 +2675,7 @@ uint32_t *EMIT_MOVES(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
 {
     uint8_t cc = RA_GetCC(&ptr);
     uint8_t size = (opcode >> 6) & 3;
-    uint16_t opcode2 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode2 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     uint32_t *tmp;
     uint32_t *tmp_priv;
     uint8_t ext_count = 1;
@@ -2682,8 +2683,6 @@ uint32_t *EMIT_MOVES(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
     
     size = size == 0 ? 1 : size == 1 ? 2 : 4;
 
-    ptr = EMIT_FlushPC(ptr);
-
     /* Test if supervisor mode is active */
     *ptr++ = ands_immed(31, cc, 1, 32 - SRB_S);
 
@@ -2758,6 +2757,8 @@ uint32_t *EMIT_MOVES(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
     *ptr++ = b_cc(A64_CC_AL, 0);
 
     *tmp_priv = b_cc(A64_CC_EQ, ptr - tmp_priv);
+    /* Main path advanced the PC register by itself, exception path brings it up to the instruction */
+    ptr = EMIT_SyncPC(ptr, 0);
     ptr = EMIT_Exception(ptr, VECTOR_PRIVILEGE_VIOLATION, 0);
 
     (*m68k_ptr) += ext_count;
@@ -3015,7 +3016,7 @@ static struct OpcodeDef InsnTable[4096] = {
 uint32_t *EMIT_line0(uint32_t *ptr, uint16_t **m68k_ptr, uint16_t *insn_consumed)
 {
 
-    uint16_t opcode = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     *insn_consumed = 1;
     (*m68k_ptr)++;
 
@@ -3053,7 +3054,7 @@ uint32_t GetSR_Line0(uint16_t opcode)
 
 int M68K_GetLine0Length(uint16_t *insn_stream)
 {
-    uint16_t opcode = cache_read_16(ICACHE, (uintptr_t)&(*insn_stream));
+    uint16_t opcode = M68K_FetchWord((uintptr_t)&(*insn_stream));
     
     int length = 0;
     int need_ea = 0;
@@ -11,6 +11,7 @@
 #include "M68k.h"
 #include "RegisterAllocator.h"
 #include "cache.h"
+#include "config.h"
 
 uint32_t *EMIT_MUL_DIV(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr);
 
@@ -877,6 +878,8 @@ uint32_t *EMIT_TST(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr, uint16_t
     ptr = EMIT_AdvancePC(ptr, 2 * (ext_count + 1));
     (*m68k_ptr) += ext_count;
 
+    update_mask = RA_DeferCC(LAZY_CC_NZ00, update_mask);
+
     if (update_mask)
     {
         uint8_t cc = RA_ModifyCC(&ptr);
@@ -970,8 +973,6 @@ static uint32_t *EMIT_MOVEfromSR(uint32_t *ptr, uint16_t opcode, uint16_t **m68k
     uint8_t ext_words = 0;
     uint32_t *tmpptr;
 
-    ptr = EMIT_FlushPC(ptr);
-
     /* Test if supervisor mode is active */
     *ptr++ = ands_immed(31, cc, 1, 32 - SRB_S);
     tmpptr = ptr;
@@ -993,7 +994,8 @@ static uint32_t *EMIT_MOVEfromSR(uint32_t *ptr, uint16_t opcode, uint16_t **m68k
     tmpptr = ptr;
     *ptr++ = b_cc(A64_CC_AL, 0);
 
-    /* No supervisor. Update USP, generate exception */
+    /* No supervisor. Update USP, generate exception. PC register is brought up to date on this path only */
+    ptr = EMIT_SyncPC(ptr, 0);
     ptr = EMIT_Exception(ptr, VECTOR_PRIVILEGE_VIOLATION, 0);
     
     *tmpptr = b_cc(A64_CC_AL, ptr - tmpptr);
@@ -1088,6 +1090,9 @@ static uint32_t *EMIT_MOVEtoSR(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_p
     *ptr++ = and_reg(cc, changed, src, LSL, 0);
     *ptr++ = eor_reg(changed, orig, cc, LSL, 0);
 
+    /* Stack may be switched, return addresses remembered so far are not valid anymore */
+    ptr = EMIT_ResetReturnStack(ptr, 0xff);
+
     /* If neither S nor M changed, go further */
     *ptr++ = ands_immed(31, changed, 2, 32 - SRB_M);
     *ptr++ = b_cc(A64_CC_EQ, 12);
@@ -1173,7 +1178,7 @@ static uint32_t *EMIT_EXT(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr, u
         then combine both to extb.l 
     */
 
-    if ((mode == 2) && (opcode ^ cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0])) == 0x40) {
+    if ((mode == 2) && (opcode ^ M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0])) == 0x40) {
         (*m68k_ptr)++;
         mode = 7;
         (*insn_consumed)++;
@@ -1225,7 +1230,7 @@ static uint32_t *EMIT_LINK32(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr
     uint8_t sp;
     uint8_t displ;
     uint8_t reg;
-    int32_t offset = (cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]) << 16) | cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[1]);
+    int32_t offset = (M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]) << 16) | M68K_FetchWord((uintptr_t)&(*m68k_ptr)[1]);
 
     displ = RA_AllocARMRegister(&ptr);
     *ptr++ = movw_immed_u16(displ, offset & 0xffff);
@@ -1260,7 +1265,7 @@ static uint32_t *EMIT_LINK16(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr
     uint8_t sp;
     uint8_t displ;
     uint8_t reg;
-    int16_t offset = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    int16_t offset = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
 
     displ = RA_AllocARMRegister(&ptr);
 
@@ -1472,7 +1477,6 @@ static uint32_t *EMIT_NOP(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr, u
 
     *ptr++ = dsb_sy();
     ptr = EMIT_AdvancePC(ptr, 2);
-    ptr = EMIT_FlushPC(ptr);
 
     return ptr;
 }
@@ -1483,7 +1487,7 @@ static uint32_t *EMIT_STOP(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr,
     (void)opcode;
 
     uint32_t *tmpptr;
-    uint16_t new_sr = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]) & 0xf71f;
+    uint16_t new_sr = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]) & 0xf71f;
     uint8_t changed = RA_AllocARMRegister(&ptr);
     uint8_t orig = RA_AllocARMRegister(&ptr);
     uint8_t cc = RA_ModifyCC(&ptr);
@@ -1516,6 +1520,9 @@ static uint32_t *EMIT_STOP(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr,
 
     /* Perform eventual stack switch */
 
+    /* Stack may be switched, return addresses remembered so far are not valid anymore */
+    ptr = EMIT_ResetReturnStack(ptr, 0xff);
+
     /* If neither S nor M changed, go further */
     *ptr++ = ands_immed(31, changed, 2, 32 - SRB_M);
     *ptr++ = b_cc(A64_CC_EQ, 12);
@@ -1652,6 +1659,9 @@ static uint32_t *EMIT_RTE(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr, u
     *ptr++ = eor_reg(cc, changed, cc, LSL, 0);       
 
     /* Now since stack is cleaned up, perform eventual stack switch */
+    /* Return addresses remembered so far are not valid anymore */
+    ptr = EMIT_ResetReturnStack(ptr, 0xff);
+
     /* If neither S nor M changed, go further */
     *ptr++ = ands_immed(31, changed, 2, 32 - SRB_M);
     *ptr++ = b_cc(A64_CC_EQ, 12);
@@ -1701,7 +1711,7 @@ static uint32_t *EMIT_RTD(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr, u
     uint8_t tmp = RA_AllocARMRegister(&ptr);
     uint8_t tmp2 = RA_AllocARMRegister(&ptr);
     uint8_t sp = RA_MapM68kRegister(&ptr, 15);
-    int16_t addend = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    int16_t addend = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
 
     /* Fetch return address from stack */
     *ptr++ = ldr_offset_postindex(sp, tmp2, 4);
@@ -1783,7 +1793,10 @@ static uint32_t *EMIT_RTS(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr, u
         *ptr++ = INSN_TO_LE(0xfffffffe);
     }
     else
+    {
+        M68K_SetReturnExit();
         *ptr++ = INSN_TO_LE(0xffffffff);
+    }
 
     return ptr;
 }
@@ -1796,12 +1809,12 @@ static uint32_t *EMIT_TRAPV(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr,
     uint8_t cc = RA_GetCC(&ptr);
     uint32_t *tmpptr;
     ptr = EMIT_AdvancePC(ptr, 2);
-    ptr = EMIT_FlushPC(ptr);
 
     *ptr++ = ands_immed(31, cc, 1, 32 - SRB_Valt);
     tmpptr = ptr;
     *ptr++ = b_cc(A64_CC_EQ, 0);
     
+    ptr = EMIT_SyncPC(ptr, 0);
     ptr = EMIT_Exception(ptr, VECTOR_TRAPcc, 2, (uint32_t)(uintptr_t)(*m68k_ptr - 1));
 
     *tmpptr = b_cc(A64_CC_EQ, ptr - tmpptr);
@@ -1847,7 +1860,7 @@ static uint32_t *EMIT_MOVEC(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr,
 {
     (void)insn_consumed;
 
-    uint16_t opcode2 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode2 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     uint8_t dr = opcode & 1;
     uint8_t reg = RA_MapM68kRegister(&ptr, opcode2 >> 12);
     uint8_t ctx = RA_GetCTX(&ptr);
@@ -1980,6 +1993,28 @@ static uint32_t *EMIT_MOVEC(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr,
             case 0x1e0: /* JITCTRL2 - JIT second control register */
                 *ptr++ = str_offset(ctx, reg, __builtin_offsetof(struct M68KState, JIT_CONTROL2));
                 break;
+            case 0x1e1: /* JITHOTTHRESH - Number of entries after which first tier unit is retranslated */
+                *ptr++ = str_offset(ctx, reg, __builtin_offsetof(struct M68KState, JIT_TIER_THRESH));
+                break;
+#if EMU68_JIT_SNAPSHOT
+            case 0x1e2: /* JITSNAPSHOT - Write snapshot of JIT units translated from ROM at given address */
+                u.u64 = (uintptr_t)M68K_SaveSnapshot;
+                *ptr++ = stp64_preindex(31, 0, 1, -176);
+                for (int i=2; i < 20; i+=2)
+                    *ptr++ = stp64(31, i, i + 1, i * 8);
+                *ptr++ = stp64(31, 29, 30, 160);
+                *ptr++ = mov_reg(0, reg);
+                *ptr++ = mov64_immed_u16(1, u.u16[3], 0);
+                *ptr++ = movk64_immed_u16(1, u.u16[2], 1);
+                *ptr++ = movk64_immed_u16(1, u.u16[1], 2);
+                *ptr++ = movk64_immed_u16(1, u.u16[0], 3);
+                *ptr++ = blr(1);
+                for (int i=2; i < 20; i+=2)
+                    *ptr++ = ldp64(31, i, i + 1, i * 8);
+                *ptr++ = ldp64(31, 29, 30, 160);
+                *ptr++ = ldp64_postindex(31, 0, 1, 176);
+                break;
+#endif
             case 0x003: // TCR - write bits 15, 14, read all zeros for now
                 tmp = RA_AllocARMRegister(&ptr);
                 *ptr++ = bic_immed(tmp, reg, 30, 16);
@@ -2203,6 +2238,14 @@ static uint32_t *EMIT_MOVEC(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr,
             case 0x1e0: /* JITCTRL2 - JIT second control register */
                 *ptr++ = ldr_offset(ctx, reg, __builtin_offsetof(struct M68KState, JIT_CONTROL2));
                 break;
+            case 0x1e1: /* JITHOTTHRESH - Number of entries after which first tier unit is retranslated */
+                *ptr++ = ldr_offset(ctx, reg, __builtin_offsetof(struct M68KState, JIT_TIER_THRESH));
+                break;
+#if EMU68_JIT_SNAPSHOT
+            case 0x1e2: /* JITSNAPSHOT - Size of last written snapshot */
+                *ptr++ = ldr_offset(ctx, reg, __builtin_offsetof(struct M68KState, JIT_SNAPSHOT_SIZE));
+                break;
+#endif
             case 0x003: // TCR - write bits 15, 14, read all zeros for now
                 *ptr++ = ldrh_offset(ctx, reg, __builtin_offsetof(struct M68KState, TCR));
                 break;
@@ -2301,6 +2344,8 @@ static uint32_t *EMIT_JSR(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr, u
     *ptr++ = mov_reg(REG_PC, ea);
     (*m68k_ptr) += ext_words;
     RA_FreeARMRegister(&ptr, ea);
+    ptr = EMIT_PushReturnStack(ptr, *m68k_ptr);
+    M68K_SetIndirectExit();
     *ptr++ = INSN_TO_LE(0xffffffff);
 
     return ptr;
@@ -2316,6 +2361,7 @@ static uint32_t *EMIT_JMP(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr, u
     ptr = EMIT_ResetOffsetPC(ptr);
     (*m68k_ptr) += ext_words;
     RA_FreeARMRegister(&ptr, ea);
+    M68K_SetIndirectExit();
     *ptr++ = INSN_TO_LE(0xffffffff);
 
     return ptr;
@@ -2491,11 +2537,10 @@ static uint32_t *EMIT_MOVEM(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr,
     (void)insn_consumed;
     uint8_t dir = (opcode >> 10) & 1;
     uint8_t size = (opcode >> 6) & 1;
-    uint16_t mask = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t mask = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     uint8_t block_size = 0;
     uint8_t ext_words = 0;
     extern int debug;
-    uint32_t *ptr_orig = ptr;
 
     (*m68k_ptr)++;
 
@@ -2666,10 +2711,6 @@ static uint32_t *EMIT_MOVEM(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr,
     ptr = EMIT_AdvancePC(ptr, 2*(ext_words + 1));
     (*m68k_ptr) += ext_words;
 
-    /* No opcode was emited? At least flush PC counter now */
-    if (ptr == ptr_orig)
-        ptr = EMIT_FlushPC(ptr);
-
     return ptr;
 }
 
@@ -2732,8 +2773,6 @@ static uint32_t *EMIT_CHK(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr, u
     ptr = EMIT_AdvancePC(ptr, 2 * (ext_words + 1));
     (*m68k_ptr) += ext_words;
 
-    ptr = EMIT_FlushPC(ptr);
-
     /* Check if Dn < 0 */
     if (opcode & 0x80)
         *ptr++ = adds_reg(31, 31, dn, LSL, 16); 
@@ -2756,6 +2795,7 @@ static uint32_t *EMIT_CHK(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr, u
 
     *ptr++ = orr_immed(cc, cc, 1, 31 & (32 - SRB_N));
 
+    ptr = EMIT_SyncPC(ptr, 0);
     ptr = EMIT_Exception(ptr, VECTOR_CHK, 2, opcode_address);
 
     RA_FreeARMRegister(&ptr, src);
@@ -2981,7 +3021,7 @@ static struct OpcodeDef InsnTable[4096] = {
 
 uint32_t *EMIT_line4(uint32_t *ptr, uint16_t **m68k_ptr, uint16_t *insn_consumed)
 {
-    uint16_t opcode = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     (*m68k_ptr)++;
     *insn_consumed = 1;
 
@@ -3020,7 +3060,7 @@ uint32_t GetSR_Line4(uint16_t opcode)
 
 int M68K_GetLine4Length(uint16_t *insn_stream)
 {
-    uint16_t opcode = cache_read_16(ICACHE, (uintptr_t)&(*insn_stream));
+    uint16_t opcode = M68K_FetchWord((uintptr_t)&(*insn_stream));
     
     int length = 0;
     int need_ea = 0;
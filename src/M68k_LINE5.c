@@ -631,11 +631,11 @@ uint32_t *EMIT_TRAPcc(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
             *ptr++ = INSN_TO_LE(0xffffffff);
             break;
     }
-    ptr = EMIT_FlushPC(ptr);
 
     /* If condition is TRUE, always generate exception */
     if (m68k_condition == M_CC_T)
     {
+        ptr = EMIT_FlushPC(ptr);
         ptr = EMIT_Exception(ptr, VECTOR_TRAPcc, 2, source);
         *ptr++ = INSN_TO_LE(0xffffffff);
     }
@@ -647,6 +647,7 @@ uint32_t *EMIT_TRAPcc(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
 
         tmpptr = ptr;
         *ptr++ = b_cc(arm_condition ^ 1, 0);
+        ptr = EMIT_SyncPC(ptr, 0);
         ptr = EMIT_Exception(ptr, VECTOR_TRAPcc, 2, source);
         *tmpptr = b_cc(arm_condition ^ 1, ptr - tmpptr);
         *ptr++ = (uint32_t)(uintptr_t)tmpptr;
@@ -658,6 +659,185 @@ uint32_t *EMIT_TRAPcc(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
     return ptr;
 }
 
+#if EMU68_BLOCK_LOOPS
+enum {
+    BLOCK_NONE,
+    BLOCK_COPY,         /* move (Ay)+,(Ax)+ */
+    BLOCK_CLEAR,        /* clr (Ax)+ */
+    BLOCK_FILL,         /* move Dy,(Ax)+ */
+};
+
+/*
+    Check if single instruction body of a DBF loop moves a block of words or longs, i.e.
+
+        loop:   move.l  (a0)+,(a1)+
+                dbf     d0,loop
+
+    Returns the kind of the loop, register numbers of destination An and of source An or Dn, and
+    the element size. The counter must not be used as the source.
+*/
+static int GetBlockLoop(uint16_t body, uint8_t counter, uint8_t *dst, uint8_t *src, uint8_t *size)
+{
+    *dst = (body >> 9) & 7;
+    *src = body & 7;
+    *size = 4;
+
+    switch (body & 0xf1f8)
+    {
+        case 0x30d8:
+            *size = 2;
+            /* Fallthrough */
+        case 0x20d8:
+            return *src != *dst ? BLOCK_COPY : BLOCK_NONE;
+
+        case 0x30c0:
+            *size = 2;
+            /* Fallthrough */
+        case 0x20c0:
+            return *src != counter ? BLOCK_FILL : BLOCK_NONE;
+    }
+
+    *dst = body & 7;
+
+    switch (body & 0xfff8)
+    {
+        case 0x4258:
+            *size = 2;
+            return BLOCK_CLEAR;
+        case 0x4298:
+            return BLOCK_CLEAR;
+    }
+
+    return BLOCK_NONE;
+}
+
+/*
+    Emit all remaining iterations of a block copy or fill loop at once, 32 bytes per step with a
+    scalar tail. Counter is left at zero so that DBF emitted afterwards ends the loop. Address
+    registers and condition codes end up as if the loop was run instruction by instruction.
+    Loops touching the lower 16MB (CHIP memory, custom chips and other PiStorm bus areas), wrapping
+    around the end of address space or copying between overlapping areas run the usual way.
+*/
+static uint32_t *EMIT_BlockLoop(uint32_t *ptr, uint8_t counter_reg, int kind, uint8_t dst, uint8_t src, uint8_t size)
+{
+    uint8_t cc = RA_ModifyCC(&ptr);
+    uint8_t reg_dst = RA_MapM68kRegister(&ptr, 8 + dst);
+    uint8_t reg_src = 31;
+    uint8_t count = RA_AllocARMRegister(&ptr);
+    uint8_t tmp = RA_AllocARMRegister(&ptr);
+    uint8_t v_lo = RA_AllocFPURegister(&ptr);
+    uint8_t v_hi = v_lo;
+    uint8_t update_mask = SR_NZVC;
+    uint32_t *exit[8];
+    uint32_t *tmpptr;
+    int exit_count = 0;
+
+    RA_SetDirtyM68kRegister(&ptr, 8 + dst);
+
+    if (kind == BLOCK_COPY)
+    {
+        reg_src = RA_MapM68kRegister(&ptr, 8 + src);
+        RA_SetDirtyM68kRegister(&ptr, 8 + src);
+        v_hi = RA_AllocFPURegister(&ptr);
+    }
+    else if (kind == BLOCK_FILL)
+    {
+        reg_src = RA_MapM68kRegister(&ptr, src);
+    }
+
+    /* Bytes left to move, nothing to do if the loop ends now */
+    *ptr++ = uxth(count, counter_reg);
+    exit[exit_count++] = ptr;
+    *ptr++ = cbz(count, 0);
+    *ptr++ = lsl(count, count, size == 4 ? 2 : 1);
+
+    /* Destination has to be above 16MB and must not wrap around */
+    *ptr++ = lsr(tmp, reg_dst, 24);
+    exit[exit_count++] = ptr;
+    *ptr++ = cbz(tmp, 0);
+    *ptr++ = add64_reg(tmp, reg_dst, count, LSL, 0);
+    *ptr++ = lsr64(tmp, tmp, 32);
+    exit[exit_count++] = ptr;
+    *ptr++ = cbnz_64(tmp, 0);
+
+    if (kind == BLOCK_COPY)
+    {
+        /* Same for the source */
+        *ptr++ = lsr(tmp, reg_src, 24);
+        exit[exit_count++] = ptr;
+        *ptr++ = cbz(tmp, 0);
+        *ptr++ = add64_reg(tmp, reg_src, count, LSL, 0);
+        *ptr++ = lsr64(tmp, tmp, 32);
+        exit[exit_count++] = ptr;
+        *ptr++ = cbnz_64(tmp, 0);
+
+        /* Areas must not overlap */
+        *ptr++ = sub_reg(tmp, reg_dst, reg_src, LSL, 0);
+        *ptr++ = cmp_reg(tmp, count, LSL, 0);
+        exit[exit_count++] = ptr;
+        *ptr++ = b_cc(A64_CC_CC, 0);
+        *ptr++ = sub_reg(tmp, reg_src, reg_dst, LSL, 0);
+        *ptr++ = cmp_reg(tmp, count, LSL, 0);
+        exit[exit_count++] = ptr;
+        *ptr++ = b_cc(A64_CC_CC, 0);
+    }
+    else if (kind == BLOCK_CLEAR)
+        *ptr++ = movi_v64(v_lo, 0);
+    else
+        *ptr++ = dup_reg(v_lo, size == 4 ? TS_S : TS_H, reg_src);
+
+    /* 32 bytes per step */
+    *ptr++ = lsr(tmp, count, 5);
+    tmpptr = ptr;
+    *ptr++ = cbz(tmp, 0);
+    if (kind == BLOCK_COPY)
+        *ptr++ = fldpq_postindex(v_lo, v_hi, reg_src, 32);
+    *ptr++ = fstpq_postindex(v_lo, v_hi, reg_dst, 32);
+    *ptr++ = subs_immed(tmp, tmp, 1);
+    *ptr++ = b_cc(A64_CC_NE, kind == BLOCK_COPY ? -3 : -2);
+    *tmpptr = cbz(tmp, ptr - tmpptr);
+
+    /* Remaining elements one by one */
+    *ptr++ = and_immed(count, count, 5, 0);
+    tmpptr = ptr;
+    *ptr++ = cbz(count, 0);
+    if (kind == BLOCK_COPY)
+    {
+        *ptr++ = size == 4 ? ldr_offset_postindex(reg_src, tmp, 4) : ldrh_offset_postindex(reg_src, tmp, 2);
+        *ptr++ = size == 4 ? str_offset_postindex(reg_dst, tmp, 4) : strh_offset_postindex(reg_dst, tmp, 2);
+    }
+    else
+        *ptr++ = size == 4 ? str_offset_postindex(reg_dst, reg_src, 4) : strh_offset_postindex(reg_dst, reg_src, 2);
+    *ptr++ = subs_immed(count, count, size);
+    *ptr++ = b_cc(A64_CC_NE, kind == BLOCK_COPY ? -3 : -2);
+    *tmpptr = cbz(count, ptr - tmpptr);
+
+    /* Flags of the last element moved */
+    if (kind == BLOCK_COPY)
+    {
+        *ptr++ = size == 4 ? ldur_offset(reg_dst, tmp, -4) : ldurh_offset(reg_dst, tmp, -2);
+        *ptr++ = cmn_reg(31, tmp, LSL, size == 4 ? 0 : 16);
+    }
+    else
+        *ptr++ = cmn_reg(31, reg_src, LSL, size == 4 ? 0 : 16);
+    ptr = EMIT_GetNZ00(ptr, cc, &update_mask);
+
+    *ptr++ = bfi(counter_reg, 31, 0, 16);
+
+    /* All exits skip to the usual DBF */
+    for (int i=0; i < exit_count; i++)
+        *exit[i] = INSN_TO_LE(INSN_TO_LE(*exit[i]) + ((ptr - exit[i]) << 5));
+
+    if (v_hi != v_lo)
+        RA_FreeFPURegister(&ptr, v_hi);
+    RA_FreeFPURegister(&ptr, v_lo);
+    RA_FreeARMRegister(&ptr, tmp);
+    RA_FreeARMRegister(&ptr, count);
+
+    return ptr;
+}
+#endif
+
 uint32_t *EMIT_DBcc(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
 {
     extern struct M68KState *__m68k_state;
@@ -666,7 +846,7 @@ uint32_t *EMIT_DBcc(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
     uint8_t arm_condition = 0;
     uint32_t *branch_1 = NULL;
     uint32_t *branch_2 = NULL;
-    int32_t branch_offset = 2 + (int16_t)cache_read_16(ICACHE, (uintptr_t)&(*(*m68k_ptr)++));
+    int32_t branch_offset = 2 + (int16_t)M68K_FetchWord((uintptr_t)&(*(*m68k_ptr)++));
     uint16_t *bra_rel_ptr = *m68k_ptr - 2;
 
     /* Selcom case of DBT which does nothing */
@@ -683,6 +863,22 @@ uint32_t *EMIT_DBcc(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
         int8_t off8 = 0;
         int32_t off = 4;
 
+#if EMU68_BLOCK_LOOPS
+        /* Copy and fill loops consisting of one instruction move the whole block at once */
+        if (m68k_condition == M_CC_F && branch_offset == -2 && (__m68k_state->JIT_CONTROL2 & JC2F_BLOCK_LOOPS))
+        {
+            uint8_t dst, src, size;
+            int kind = GetBlockLoop(M68K_FetchWord((uintptr_t)(bra_rel_ptr - 1)), opcode & 7, &dst, &src, &size);
+
+            if (kind != BLOCK_NONE)
+                ptr = EMIT_BlockLoop(ptr, counter_reg, kind, dst, src, size);
+        }
+#endif
+
+        /* Loop branching backwards, prefetch its streams */
+        if (branch_offset < 0)
+            ptr = EMIT_LoopPrefetch(ptr, (uint16_t *)((uintptr_t)bra_rel_ptr + branch_offset), bra_rel_ptr);
+
         // Suggested by Paraj - a way to allow old code using DBF as busy loop work:
         // For busy loops (of the form l dbf dN,l) in chip mem add extra delay that is
         // at least 10 7MHz clocks (For old school replayer routines)
@@ -766,7 +962,7 @@ uint32_t *EMIT_DBcc(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
 
         *ptr++ = (uint32_t)(uintptr_t)branch_2;
         *ptr++ = 1;
-        *ptr++ = 0;
+        *ptr++ = (uint32_t)(uintptr_t)(bra_rel_ptr + 2);
         *ptr++ = INSN_TO_LE(0xfffffffe);
         *ptr++ = INSN_TO_LE(0xfffffff1);
 
@@ -822,7 +1018,7 @@ static struct OpcodeDef InsnTable[512] = {
 
 uint32_t *EMIT_line5(uint32_t *ptr, uint16_t **m68k_ptr, uint16_t *insn_consumed)
 {
-    uint16_t opcode = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     (*m68k_ptr)++;
     *insn_consumed = 1;
 
@@ -861,7 +1057,7 @@ uint32_t GetSR_Line5(uint16_t opcode)
 
 int M68K_GetLine5Length(uint16_t *insn_stream)
 {
-    uint16_t opcode = cache_read_16(ICACHE, (uintptr_t)&(*insn_stream));
+    uint16_t opcode = M68K_FetchWord((uintptr_t)&(*insn_stream));
     
     int length = 0;
     int need_ea = 0;
@@ -15,6 +15,7 @@
 
 extern struct M68KState *__m68k_state;
 extern uint16_t * m68k_entry_point;
+extern int32_t var_EMU68_BRANCH_INLINE_DISTANCE;
 
 uint32_t *EMIT_BRA(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
 {
@@ -34,14 +35,14 @@ uint32_t *EMIT_BRA(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
     if ((opcode & 0x00ff) == 0x00)
     {
         addend = 2;
-        bra_off = (int16_t)(cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]));
+        bra_off = (int16_t)(M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]));
         (*m68k_ptr)++;
     }
     /* use 32-bit offset */
     else if ((opcode & 0x00ff) == 0xff)
     {
         addend = 4;
-        bra_off = (int32_t)(cache_read_32(ICACHE, (uintptr_t)&(*m68k_ptr)[0]));
+        bra_off = (int32_t)(M68K_FetchLong((uintptr_t)&(*m68k_ptr)[0]));
         (*m68k_ptr) += 2;
     }
     else
@@ -97,8 +98,6 @@ uint32_t *EMIT_BRA(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
     }
     RA_FreeARMRegister(&ptr, reg);
 
-    int32_t var_EMU68_BRANCH_INLINE_DISTANCE = (__m68k_state->JIT_CONTROL >> JCCB_INLINE_RANGE) & JCCB_INLINE_RANGE_MASK;
-
     /* If branch is done within +- 4KB, try to inline it instead of breaking up the translation unit */
     if ((uintptr_t)*m68k_ptr >= 0x01000000 && (bra_off >= -var_EMU68_BRANCH_INLINE_DISTANCE && bra_off <= var_EMU68_BRANCH_INLINE_DISTANCE)) {
         if (bsr) {
@@ -108,7 +107,14 @@ uint32_t *EMIT_BRA(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
         *m68k_ptr = (void *)((uintptr_t)bra_rel_ptr + bra_off);
     }
     else
+    {
+        if (bsr) {
+            ptr = EMIT_PushReturnStack(ptr, *m68k_ptr);
+        }
+
+        M68K_SetExitTarget((uint16_t *)((uintptr_t)bra_rel_ptr + bra_off));
         *ptr++ = INSN_TO_LE(0xffffffff);
+    }
 
     return ptr;
 }
@@ -124,6 +130,7 @@ uint32_t *EMIT_Bcc(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
     intptr_t branch_offset = 0;
     int8_t local_pc_off = 2;
     int take_branch = 1;
+    uint16_t *bcc_insn = *m68k_ptr - 1;
 
     ptr = EMIT_GetOffsetPC(ptr, &local_pc_off);
     ptr = EMIT_ResetOffsetPC(ptr);
@@ -131,14 +138,14 @@ uint32_t *EMIT_Bcc(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
     /* use 16-bit offset */
     if ((opcode & 0x00ff) == 0x00)
     {
-        branch_offset = (int16_t)cache_read_16(ICACHE, (uintptr_t)&(*(*m68k_ptr)++));
+        branch_offset = (int16_t)M68K_FetchWord((uintptr_t)&(*(*m68k_ptr)++));
     }
     /* use 32-bit offset */
     else if ((opcode & 0x00ff) == 0xff)
     {
         uint16_t lo16, hi16;
-        hi16 = cache_read_16(ICACHE, (uintptr_t)&(*(*m68k_ptr)++));
-        lo16 = cache_read_16(ICACHE, (uintptr_t)&(*(*m68k_ptr)++));
+        hi16 = M68K_FetchWord((uintptr_t)&(*(*m68k_ptr)++));
+        lo16 = M68K_FetchWord((uintptr_t)&(*(*m68k_ptr)++));
         branch_offset = lo16 | (hi16 << 16);
     }
     else
@@ -150,12 +157,18 @@ uint32_t *EMIT_Bcc(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
     branch_offset += local_pc_off;
     branch_target += branch_offset - local_pc_off;
 
+    /* Loop branching backwards, prefetch its streams */
+    if ((uint16_t *)branch_target < bcc_insn)
+        ptr = EMIT_LoopPrefetch(ptr, (uint16_t *)branch_target, bcc_insn);
+
 #if EMU68_DEF_BRANCH_BREAK
     (void)take_branch;
     (void)tmpptr;
     (void)distance_ptr;
     
-    uint8_t success_condition = EMIT_TestCondition(&ptr, m68k_condition);
+    uint8_t success_condition = RA_ConsumeLazyCC(&ptr, m68k_condition);
+    if (success_condition == 0xff)
+        success_condition = EMIT_TestCondition(&ptr, m68k_condition);
     uint8_t pc_yes = RA_AllocARMRegister(&ptr);
     uint8_t pc_no = RA_AllocARMRegister(&ptr);
 
@@ -233,17 +246,36 @@ uint32_t *EMIT_Bcc(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
 #endif
 #endif
 
+    /*
+        Hot unit is being retranslated and the exit of this branch was taken most of the time.
+        Follow that side now. Branch target is followed only if it is close enough to be inlined.
+    */
+    if (M68K_IsHotExit())
+    {
+        if (take_branch)
+            take_branch = 0;
+        else if (_abs(branch_target - (intptr_t)*m68k_ptr) <= var_EMU68_BRANCH_INLINE_DISTANCE)
+            take_branch = 1;
+    }
+
     if (!take_branch)
     {
         m68k_condition ^= 1;
     }
 
+    /* Flags may still be in host NZCV, if so branch on them directly */
+    uint8_t host_condition = RA_ConsumeLazyCC(&ptr, m68k_condition);
+
     /* Force getting CC in place */
-    RA_GetCC(&ptr);
+    if (host_condition == 0xff)
+        RA_GetCC(&ptr);
 
     /* Prepare fake jump on condition, assume def branch is taken */
     tmpptr = ptr;
-    ptr = EMIT_JumpOnCondition(ptr, m68k_condition, 0);
+    if (host_condition != 0xff)
+        *ptr++ = b_cc(host_condition, 0);
+    else
+        ptr = EMIT_JumpOnCondition(ptr, m68k_condition, 0);
     distance_ptr = ptr;
 
     /* Insert the first case here */
@@ -292,11 +324,14 @@ uint32_t *EMIT_Bcc(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
         }
     }
 
-    /* Insert local exit */
-    ptr = EMIT_LocalExit(ptr, 1);
+    /* Insert local exit. Its target is known, so it can be chained with the next unit */
+    ptr = EMIT_LinkedExit(ptr, 1, take_branch ? *m68k_ptr : (uint16_t *)branch_target);
 
     /* Fixup jump on condition */
-    EMIT_JumpOnCondition(tmpptr, m68k_condition, 1 + ptr - distance_ptr);
+    if (host_condition != 0xff)
+        *tmpptr = b_cc(host_condition, 1 + ptr - distance_ptr);
+    else
+        EMIT_JumpOnCondition(tmpptr, m68k_condition, 1 + ptr - distance_ptr);
 
     /* Insert the second case here */
     if (!take_branch)
@@ -372,7 +407,7 @@ static struct OpcodeDef InsnTable[16] = {
 
 uint32_t *EMIT_line6(uint32_t *ptr, uint16_t **m68k_ptr, uint16_t *insn_consumed)
 {
-    uint16_t opcode = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     *insn_consumed = 1;
     (*m68k_ptr)++;
 
@@ -388,7 +423,7 @@ uint32_t GetSR_Line6(uint16_t opcode)
 
 int M68K_GetLine6Length(uint16_t *insn_stream)
 {
-    uint16_t opcode = cache_read_16(ICACHE, (uintptr_t)insn_stream);
+    uint16_t opcode = M68K_FetchWord((uintptr_t)insn_stream);
     int length = 1;
     
     if ((opcode & 0xff) == 0) {
@@ -38,6 +38,8 @@ static uint32_t *EMIT_CMPA_ext(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_p
     ptr = EMIT_AdvancePC(ptr, 2 * (ext_words + 1));
     (*m68k_ptr) += ext_words;
 
+    update_mask = RA_DeferCC(LAZY_CC_NZnCV, update_mask);
+
     if (update_mask)
     {
         uint8_t cc = RA_ModifyCC(&ptr);
@@ -95,6 +97,8 @@ static uint32_t *EMIT_CMPM(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
     ptr = EMIT_AdvancePC(ptr, 2 * (ext_words + 1));
     (*m68k_ptr) += ext_words;
 
+    update_mask = RA_DeferCC(LAZY_CC_NZnCV, update_mask);
+
     if (update_mask)
     {
         uint8_t cc = RA_ModifyCC(&ptr);
@@ -156,6 +160,8 @@ static uint32_t *EMIT_CMP_ext(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_pt
     ptr = EMIT_AdvancePC(ptr, 2 * (ext_words + 1));
     (*m68k_ptr) += ext_words;
 
+    update_mask = RA_DeferCC(LAZY_CC_NZnCV, update_mask);
+
     if (update_mask)
     {
         uint8_t cc = RA_ModifyCC(&ptr);
@@ -375,7 +381,7 @@ static struct OpcodeDef InsnTable[512] = {
 
 uint32_t *EMIT_lineB(uint32_t *ptr, uint16_t **m68k_ptr, uint16_t *insn_consumed)
 {
-    uint16_t opcode = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     (*m68k_ptr)++;
     *insn_consumed = 1;
 
@@ -416,7 +422,7 @@ uint32_t GetSR_LineB(uint16_t opcode)
 
 int M68K_GetLineBLength(uint16_t *insn_stream)
 {
-    uint16_t opcode = cache_read_16(ICACHE, (uintptr_t)insn_stream);
+    uint16_t opcode = M68K_FetchWord((uintptr_t)insn_stream);
     
     int length = 0;
     int need_ea = 0;
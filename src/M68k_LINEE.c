@@ -2774,7 +2774,7 @@ static uint32_t *EMIT_BFTST_reg(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_
 {
     uint8_t update_mask = M68K_GetSRMask(&(*m68k_ptr)[-1]);
     uint8_t ext_words = 1;
-    uint16_t opcode2 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode2 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     uint8_t src = RA_MapM68kRegister(&ptr, opcode & 7);
 
     /* Direct offset and width */
@@ -2937,7 +2937,7 @@ static uint32_t *EMIT_BFTST(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
 {
     uint8_t update_mask = M68K_GetSRMask(&(*m68k_ptr)[-1]);
     uint8_t ext_words = 1;
-    uint16_t opcode2 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode2 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     uint8_t base = 0xff;
 
     // Get EA address into a temporary register
@@ -2991,7 +2991,7 @@ static uint32_t *EMIT_BFEXTU_reg(uint32_t *ptr, uint16_t opcode, uint16_t **m68k
 {
     uint8_t update_mask = M68K_GetSRMask(&(*m68k_ptr)[-1]);
     uint8_t ext_words = 1;
-    uint16_t opcode2 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode2 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
 
     /*
         IMPORTANT: Although it is not mentioned in 68000 PRM, the bitfield operations on
@@ -3182,7 +3182,7 @@ static uint32_t *EMIT_BFEXTU(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr
 {
     uint8_t update_mask = M68K_GetSRMask(&(*m68k_ptr)[-1]);
     uint8_t ext_words = 1;
-    uint16_t opcode2 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode2 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     uint8_t base = 0xff;
 
     // Get EA address into a temporary register
@@ -3240,7 +3240,7 @@ static uint32_t *EMIT_BFEXTS_reg(uint32_t *ptr, uint16_t opcode, uint16_t **m68k
 {
     uint8_t update_mask = M68K_GetSRMask(&(*m68k_ptr)[-1]);
     uint8_t ext_words = 1;
-    uint16_t opcode2 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode2 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     uint8_t src = RA_MapM68kRegister(&ptr, opcode & 7);
 
     /* Direct offset and width */
@@ -3425,7 +3425,7 @@ static uint32_t *EMIT_BFEXTS(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr
 {
     uint8_t update_mask = M68K_GetSRMask(&(*m68k_ptr)[-1]);
     uint8_t ext_words = 1;
-    uint16_t opcode2 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode2 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     uint8_t base = 0xff;
 
     // Get EA address into a temporary register
@@ -3483,7 +3483,7 @@ static uint32_t *EMIT_BFFFO_reg(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_
 {
     uint8_t update_mask = M68K_GetSRMask(&(*m68k_ptr)[-1]);
     uint8_t ext_words = 1;
-    uint16_t opcode2 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode2 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
 
     uint8_t src = RA_MapM68kRegister(&ptr, opcode & 7);
 
@@ -3689,7 +3689,7 @@ static uint32_t *EMIT_BFFFO(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
 {
     uint8_t update_mask = M68K_GetSRMask(&(*m68k_ptr)[-1]);
     uint8_t ext_words = 1;
-    uint16_t opcode2 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode2 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     uint8_t base = 0xff;
 
     // Get EA address into a temporary register
@@ -3747,7 +3747,7 @@ static uint32_t *EMIT_BFCHG_reg(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_
 {
     uint8_t update_mask = M68K_GetSRMask(&(*m68k_ptr)[-1]);
     uint8_t ext_words = 1;
-    uint16_t opcode2 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode2 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     uint8_t src = RA_MapM68kRegister(&ptr, opcode & 7);
 
     RA_SetDirtyM68kRegister(&ptr, opcode & 7);
@@ -3969,7 +3969,7 @@ static uint32_t *EMIT_BFCHG(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
 {
     uint8_t update_mask = M68K_GetSRMask(&(*m68k_ptr)[-1]);
     uint8_t ext_words = 1;
-    uint16_t opcode2 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode2 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     uint8_t base = 0xff;
 
     // Get EA address into a temporary register
@@ -4020,7 +4020,7 @@ static uint32_t *EMIT_BFSET_reg(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_
 {
     uint8_t update_mask = M68K_GetSRMask(&(*m68k_ptr)[-1]);
     uint8_t ext_words = 1;
-    uint16_t opcode2 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode2 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     uint8_t src = RA_MapM68kRegister(&ptr, opcode & 7);
 
     RA_SetDirtyM68kRegister(&ptr, opcode & 7);
@@ -4242,7 +4242,7 @@ static uint32_t *EMIT_BFSET(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
 {
     uint8_t update_mask = M68K_GetSRMask(&(*m68k_ptr)[-1]);
     uint8_t ext_words = 1;
-    uint16_t opcode2 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode2 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     uint8_t base = 0xff;
 
     // Get EA address into a temporary register
@@ -4296,7 +4296,7 @@ static uint32_t *EMIT_BFCLR_reg(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_
 {
     uint8_t update_mask = M68K_GetSRMask(&(*m68k_ptr)[-1]);
     uint8_t ext_words = 1;
-    uint16_t opcode2 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode2 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     uint8_t src = RA_MapM68kRegister(&ptr, opcode & 7);
 
     RA_SetDirtyM68kRegister(&ptr, opcode & 7);
@@ -4518,7 +4518,7 @@ static uint32_t *EMIT_BFCLR(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
 {
     uint8_t update_mask = M68K_GetSRMask(&(*m68k_ptr)[-1]);
     uint8_t ext_words = 1;
-    uint16_t opcode2 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode2 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     uint8_t base = 0xff;
 
     // Get EA address into a temporary register
@@ -4572,7 +4572,7 @@ static uint32_t *EMIT_BFINS_reg(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_
 {
     uint8_t update_mask = M68K_GetSRMask(&(*m68k_ptr)[-1]);
     uint8_t ext_words = 1;
-    uint16_t opcode2 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode2 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     uint8_t dest = RA_MapM68kRegister(&ptr, opcode & 7);
     uint8_t src = RA_MapM68kRegister(&ptr, (opcode2 >> 12) & 7);
 
@@ -4820,7 +4820,7 @@ static uint32_t *EMIT_BFINS(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
 {
     uint8_t update_mask = M68K_GetSRMask(&(*m68k_ptr)[-1]);
     uint8_t ext_words = 1;
-    uint16_t opcode2 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode2 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     uint8_t base = 0xff;
 
     uint8_t src = RA_MapM68kRegister(&ptr, (opcode2 >> 12) & 7);
@@ -5319,15 +5319,15 @@ static struct OpcodeDef InsnTable[4096] = {
 
 uint32_t *EMIT_lineE(uint32_t *ptr, uint16_t **m68k_ptr, uint16_t *insn_consumed)
 {
-    uint16_t opcode = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     (*m68k_ptr)++;
     *insn_consumed = 1;
 
     /* Special case: the combination of RO(R/L).W #8, Dn; SWAP Dn; RO(R/L).W, Dn
         this is replaced by REV instruction */
     if (((opcode & 0xfef8) == 0xe058) &&
-        cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]) == (0x4840 | (opcode & 7)) &&
-        (cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[1]) & 0xfeff) == (opcode & 0xfeff))
+        M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]) == (0x4840 | (opcode & 7)) &&
+        (M68K_FetchWord((uintptr_t)&(*m68k_ptr)[1]) & 0xfeff) == (opcode & 0xfeff))
     {
         uint8_t update_mask = M68K_GetSRMask(&(*m68k_ptr)[-1]);
         uint8_t reg = RA_MapM68kRegister(&ptr, opcode & 7);
@@ -5403,7 +5403,7 @@ uint32_t GetSR_LineE(uint16_t opcode)
 
 int M68K_GetLineELength(uint16_t *insn_stream)
 {
-    uint16_t opcode = cache_read_16(ICACHE, (uintptr_t)insn_stream);
+    uint16_t opcode = M68K_FetchWord((uintptr_t)insn_stream);
     
     int length = 0;
     int need_ea = 0;
@@ -478,7 +478,7 @@ int FPSR_Update_Needed(uint16_t *ptr, int level)
 {
     int cnt = 0;
 
-    while((cache_read_16(ICACHE, (uintptr_t)ptr) & 0xfe00) != 0xf200)
+    while((M68K_FetchWord((uintptr_t)ptr) & 0xfe00) != 0xf200)
     {
         if (cnt++ > 15)
             return 1;
@@ -491,8 +491,8 @@ int FPSR_Update_Needed(uint16_t *ptr, int level)
         ptr += len;
     }
 
-    uint16_t opcode = cache_read_16(ICACHE, (uintptr_t)&ptr[0]);
-    uint16_t opcode2 = cache_read_16(ICACHE, (uintptr_t)&ptr[1]);
+    uint16_t opcode = M68K_FetchWord((uintptr_t)&ptr[0]);
+    uint16_t opcode2 = M68K_FetchWord((uintptr_t)&ptr[1]);
 
     /* In case of FNOP check subsequent instruction */
     if (opcode == 0xf280 && opcode2 == 0x0000)
@@ -629,7 +629,7 @@ uint32_t *FPU_FetchData(uint32_t *ptr, uint16_t **m68k_ptr, uint8_t *reg, uint16
                 case SIZE_W:
                 {
                     int_reg = RA_AllocARMRegister(&ptr);
-                    int16_t imm = (int16_t)cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[1]);
+                    int16_t imm = (int16_t)M68K_FetchWord((uintptr_t)&(*m68k_ptr)[1]);
                     *ptr++ = movw_immed_u16(int_reg, imm & 0xffff);
                     if (imm < 0)
                         *ptr++ = movt_immed_u16(int_reg, 0xffff);
@@ -641,7 +641,7 @@ uint32_t *FPU_FetchData(uint32_t *ptr, uint16_t **m68k_ptr, uint8_t *reg, uint16
                 case SIZE_B:
                 {
                     int_reg = RA_AllocARMRegister(&ptr);
-                    int8_t imm = (int8_t)cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[1]);
+                    int8_t imm = (int8_t)M68K_FetchWord((uintptr_t)&(*m68k_ptr)[1]);
                     *ptr++ = mov_immed_s8(int_reg, imm);
                     *ptr++ = scvtf_32toD(*reg, int_reg);
                     *ext_count += 1;
@@ -1792,12 +1792,70 @@ void __clear_cache(void *begin, void *end);
 #define MAX_EPILOGUE_LENGTH 256
 uint32_t icache_epilogue[MAX_EPILOGUE_LENGTH];
 
+static void invalidate_unit(struct M68KTranslationUnit *u)
+{
+    extern struct M68KState *__m68k_state;
+
+    if (__m68k_state->JIT_CONTROL & JCCF_SOFT)
+    {
+        // Weak cflush. Generate invalid entry address instead of flushing. Fault handler will
+        // verify block checksum and eventually discard it
+        M68K_SoftFlushUnit(u);
+    }
+    else
+    {
+        // kprintf("[LINEF] Unit %p, %08x-%08x match! Removing.\n", u, u->mt_M68kLow, u->mt_M68kHigh);
+        M68K_UnlinkUnit(u, 1);
+        REMOVE(&u->mt_LRUNode);
+        M68K_RemoveUnit(u);
+        M68K_FreeUnit(u);
+
+        __m68k_state->JIT_UNIT_COUNT--;
+    }
+}
+
+/*
+    Invalidate all units overlapping m68k code between low and high. Only units found in page
+    directory for the pages of the range, and units spanning too many pages, are checked.
+*/
+static void invalidate_units(uintptr_t low, uintptr_t high)
+{
+    uint32_t first_page = low >> 12;
+    uint32_t last_page = high >> 12;
+    struct Node *n, *next;
+
+    for (uint32_t p = first_page; p <= last_page + 1; p++)
+    {
+        uint32_t page = p > last_page ? UNIT_PAGE_WIDE : p;
+
+        ForeachNodeSafe(M68K_GetPageUnits(page), n, next)
+        {
+            struct M68KUnitPage *up = (struct M68KUnitPage *)n;
+            struct M68KTranslationUnit *u = up->up_Unit;
+
+            if (up->up_Page != page)
+                continue;
+
+            // Unit overlapping previous page of the range was checked already
+            if (page != UNIT_PAGE_WIDE && page != first_page && ((uintptr_t)u->mt_M68kLow >> 12) < page)
+                continue;
+
+            // If highest address of unit is lower than the begin flushed area, or lowest address of unit higher than the flushed area end
+            // then skip the unit
+            if ((uintptr_t)u->mt_M68kLow > high || (uintptr_t)u->mt_M68kHigh < low)
+                continue;
+
+            invalidate_unit(u);
+        }
+    }
+}
+
 void *invalidate_instruction_cache(uintptr_t target_addr, uint16_t *pc, uint32_t *arm_pc)
 {
     int i;
-    uint16_t opcode = cache_read_16(ICACHE, (uintptr_t)&pc[0]);
+    uint16_t opcode = M68K_FetchWord((uintptr_t)&pc[0]);
     struct M68KTranslationUnit *u;
-    struct Node *n, *next;
+    struct Node *n;
     extern struct List LRU;
     extern void *jit_tlsf;
     extern struct M68KState *__m68k_state;
@@ -1829,68 +1887,11 @@ void *invalidate_instruction_cache(uintptr_t target_addr, uint16_t *pc, uint32_t
     switch (opcode & 0x18) {
         case 0x08:  /* Line */
             // kprintf("[LINEF] Invalidating line\n");
-            ForeachNodeSafe(&LRU, n, next)
-            {
-                u = (struct M68KTranslationUnit *)((intptr_t)n - __builtin_offsetof(struct M68KTranslationUnit, mt_LRUNode));
-
-                // If highest address of unit is lower than the begin flushed area, or lowest address of unit higher than the flushed area end
-                // then skip the unit
-                if ((uintptr_t)u->mt_M68kLow > ((target_addr + 16) & ~15) || (uintptr_t)u->mt_M68kHigh < (target_addr & ~15))
-                    continue;
-
-                if (__m68k_state->JIT_CONTROL & JCCF_SOFT)
-                {
-                    // Weak cflush. Generate invalid entry address instead of flushing. Fault handler will
-                    // verify block checksum and eventually discard it
-                    uintptr_t e = (uintptr_t)u->mt_ARMEntryPoint;
-                    e &= 0x00ffffffffffffffULL;
-                    e |= 0xaa00000000000000ULL;
-                    u->mt_ARMEntryPoint = (void*)e;
-                }
-                else
-                {
-                    // kprintf("[LINEF] Unit %p, %08x-%08x match! Removing.\n", u, u->mt_M68kLow, u->mt_M68kHigh);
-                    REMOVE(&u->mt_LRUNode);
-                    REMOVE(&u->mt_HashNode);
-                    tlsf_free(jit_tlsf, u);
-
-                    __m68k_state->JIT_UNIT_COUNT--;
-                    __m68k_state->JIT_CACHE_FREE = tlsf_get_free_size(jit_tlsf);
-                }
-            }
+            invalidate_units(target_addr & ~15, (target_addr + 16) & ~15);
             break;
         case 0x10:  /* Page */
             // kprintf("[LINEF] Invalidating page\n");
-            ForeachNodeSafe(&LRU, n, next)
-            {
-                u = (struct M68KTranslationUnit *)((intptr_t)n - __builtin_offsetof(struct M68KTranslationUnit, mt_LRUNode));
-
-                // If highest address of unit is lower than the begin flushed area, or lowest address of unit higher than the flushed area end
-                // then skip the unit
-                if ((uintptr_t)u->mt_M68kLow > ((target_addr + 4096) & ~4095) || (uintptr_t)u->mt_M68kHigh < (target_addr & ~4095))
-                    continue;
-
-                // kprintf("[LINEF] Unit %p, %08x-%08x match! Removing.\n", u, u->mt_M68kLow, u->mt_M68kHigh);
-
-                if (__m68k_state->JIT_CONTROL & JCCF_SOFT)
-                {
-                    // Weak cflush. Generate invalid entry address instead of flushing. Fault handler will
-                    // verify block checksum and eventually discard it
-                    uintptr_t e = (uintptr_t)u->mt_ARMEntryPoint;
-                    e &= 0x00ffffffffffffffULL;
-                    e |= 0xaa00000000000000ULL;
-                    u->mt_ARMEntryPoint = (void*)e;
-                }
-                else
-                {
-                    REMOVE(&u->mt_LRUNode);
-                    REMOVE(&u->mt_HashNode);
-                    tlsf_free(jit_tlsf, u);
-
-                    __m68k_state->JIT_UNIT_COUNT--;
-                    __m68k_state->JIT_CACHE_FREE = tlsf_get_free_size(jit_tlsf);
-                }
-            }
+            invalidate_units(target_addr & ~4095, (target_addr + 4096) & ~4095);
             break;
         case 0x18:  /* All */
             // kprintf("[LINEF] Invalidating all\n");            
@@ -1898,15 +1899,9 @@ void *invalidate_instruction_cache(uintptr_t target_addr, uint16_t *pc, uint32_t
             {
                 if (__m68k_state->JIT_UNIT_COUNT < __m68k_state->JIT_SOFTFLUSH_THRESH)
                 {
-                    ForeachNode(&LRU, n)
-                    {
-                        uintptr_t uptr = ((uintptr_t)n - __builtin_offsetof(struct M68KTranslationUnit, mt_LRUNode));
-                        uptr += __builtin_offsetof(struct M68KTranslationUnit, mt_ARMEntryPoint);
-
-                        // Weak cflush. Generate invalid entry address instead of flushing. Fault handler will
-                        // verify block checksum and eventually discard it
-                        *(uint8_t *)uptr = 0xaa;
-                    }
+                    // Weak cflush. Generate invalid entry address instead of flushing. Fault handler will
+                    // verify block checksum and eventually discard it
+                    M68K_SoftFlushAll();
                 }
                 else
                 {
@@ -1918,22 +1913,15 @@ void *invalidate_instruction_cache(uintptr_t target_addr, uint16_t *pc, uint32_t
                     {
                         u = (struct M68KTranslationUnit *)((intptr_t)n - __builtin_offsetof(struct M68KTranslationUnit, mt_LRUNode));
              
-                        REMOVE(&u->mt_HashNode);
-                        tlsf_free(jit_tlsf, u);
+                        M68K_UnlinkUnit(u, 1);
+                        M68K_RemoveUnit(u);
+                        M68K_FreeUnit(u);
                         
                         __m68k_state->JIT_UNIT_COUNT--;
                     }
-                    __m68k_state->JIT_CACHE_FREE = tlsf_get_free_size(jit_tlsf);
+                    __m68k_state->JIT_CACHE_FREE = M68K_GetCacheFree();
 #if EMU68_WEAK_CFLUSH_SLOW
-                    ForeachNode(&LRU, n)
-                    {
-                        uintptr_t uptr = ((uintptr_t)n - __builtin_offsetof(struct M68KTranslationUnit, mt_LRUNode));
-                        uptr += __builtin_offsetof(struct M68KTranslationUnit, mt_ARMEntryPoint);
-
-                        // Weak cflush. Generate invalid entry address instead of flushing. Fault handler will
-                        // verify block checksum and eventually discard it
-                        *(uint8_t *)uptr = 0xaa;
-                    }
+                    M68K_SoftFlushAll();
 #endif
                 }
             }
@@ -1942,11 +1930,12 @@ void *invalidate_instruction_cache(uintptr_t target_addr, uint16_t *pc, uint32_t
                 while ((n = REMHEAD(&LRU))) {
                     u = (struct M68KTranslationUnit *)((intptr_t)n - __builtin_offsetof(struct M68KTranslationUnit, mt_LRUNode));
                     // kprintf("[LINEF] Removing unit %p\n", u);                
-                    REMOVE(&u->mt_HashNode);
-                    tlsf_free(jit_tlsf, u);
+                    M68K_UnlinkUnit(u, 1);
+                    M68K_RemoveUnit(u);
+                    M68K_FreeUnit(u);
                 }
                 __m68k_state->JIT_UNIT_COUNT = 0;
-                __m68k_state->JIT_CACHE_FREE = tlsf_get_free_size(jit_tlsf);
+                __m68k_state->JIT_CACHE_FREE = M68K_GetCacheFree();
             }
             break;
     }
@@ -1962,8 +1951,8 @@ void __attribute__((used)) __trampoline_icache_invalidate(void)
 
 uint32_t *EMIT_FPU(uint32_t *ptr, uint16_t **m68k_ptr, uint16_t *insn_consumed)
 {
-    uint16_t opcode = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
-    uint16_t opcode2 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[1]);
+    uint16_t opcode = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode2 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[1]);
     uint8_t ext_count = 1;
     (*m68k_ptr)++;
     *insn_consumed = 1;
@@ -2123,7 +2112,6 @@ uint32_t *EMIT_FPU(uint32_t *ptr, uint16_t **m68k_ptr, uint16_t *insn_consumed)
         }
         ptr = EMIT_AdvancePC(ptr, 2 * (ext_count + 1));
         (*m68k_ptr) += ext_count;
-        ptr = EMIT_FlushPC(ptr);
     }
     /* FBcc */
     else if ((opcode & 0xff80) == 0xf280)
@@ -2256,14 +2244,14 @@ uint32_t *EMIT_FPU(uint32_t *ptr, uint16_t **m68k_ptr, uint16_t *insn_consumed)
         /* use 16-bit offset */
         if ((opcode & 0x0040) == 0x0000)
         {
-            branch_offset = (int16_t)cache_read_16(ICACHE, (uintptr_t)&(*(*m68k_ptr)++));
+            branch_offset = (int16_t)M68K_FetchWord((uintptr_t)&(*(*m68k_ptr)++));
         }
         /* use 32-bit offset */
         else
         {
             uint16_t lo16, hi16;
-            hi16 = cache_read_16(ICACHE, (uintptr_t)&(*(*m68k_ptr)++));
-            lo16 = cache_read_16(ICACHE, (uintptr_t)&(*(*m68k_ptr)++));
+            hi16 = M68K_FetchWord((uintptr_t)&(*(*m68k_ptr)++));
+            lo16 = M68K_FetchWord((uintptr_t)&(*(*m68k_ptr)++));
             branch_offset = lo16 | (hi16 << 16);
         }
 
@@ -2329,21 +2317,27 @@ uint32_t *EMIT_FPU(uint32_t *ptr, uint16_t **m68k_ptr, uint16_t *insn_consumed)
 #endif
 #endif
 
+        /* PC the exit leaves to, fall-through if the branch is followed inline */
+        intptr_t exit_target = branch_target;
 #if EMU68_DEF_BRANCH_AUTO
         if(
             branch_target < (intptr_t)*m68k_ptr &&
             ((intptr_t)*m68k_ptr - branch_target) < EMU68_DEF_BRANCH_AUTO_RANGE
         )
+        {
+            exit_target = (intptr_t)*m68k_ptr;
             *m68k_ptr = (uint16_t *)branch_target;
+        }
 #else
 #if EMU68_DEF_BRANCH_TAKEN
+        exit_target = (intptr_t)*m68k_ptr;
         *m68k_ptr = (uint16_t *)branch_target;
 #endif
 #endif
         RA_FreeARMRegister(&ptr, reg);
         *ptr++ = (uint32_t)(uintptr_t)tmpptr;
         *ptr++ = 1;
-        *ptr++ = branch_target;
+        *ptr++ = exit_target;
         *ptr++ = INSN_TO_LE(0xfffffffe);
     }
     /* FCMP */
@@ -4630,7 +4624,6 @@ uint32_t *EMIT_FPU(uint32_t *ptr, uint16_t **m68k_ptr, uint16_t *insn_consumed)
 
         ptr = EMIT_AdvancePC(ptr, 2 * (ext_count + 1));
         (*m68k_ptr) += ext_count;
-        ptr = EMIT_FlushPC(ptr);
     }
     /* FSAVE */
     else if ((opcode & ~0x3f) == 0xf300 && 
@@ -4670,8 +4663,8 @@ int DisableFPU = 0;
 
 uint32_t *EMIT_lineF(uint32_t *ptr, uint16_t **m68k_ptr, uint16_t *insn_consumed)
 {
-    uint16_t opcode = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
-    uint16_t opcode2 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[1]);
+    uint16_t opcode = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode2 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[1]);
 
     /* Check destination coprocessor - if it is FPU go to separate function */
     if (DisableFPU == 0 && (opcode & 0x0e00) == 0x0200)
@@ -4729,7 +4722,7 @@ uint32_t *EMIT_lineF(uint32_t *ptr, uint16_t **m68k_ptr, uint16_t *insn_consumed
         uint8_t buf1 = RA_AllocARMRegister(&ptr);
         uint8_t buf2 = RA_AllocARMRegister(&ptr);
         uint8_t reg = RA_MapM68kRegister(&ptr, 8 + (opcode & 7));
-        uint32_t mem = (cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[1]) << 16) | cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[2]);
+        uint32_t mem = (M68K_FetchWord((uintptr_t)&(*m68k_ptr)[1]) << 16) | M68K_FetchWord((uintptr_t)&(*m68k_ptr)[2]);
 
         /* Align memory pointer */
         mem &= 0xfffffff0;
@@ -15,7 +15,7 @@
 uint32_t *EMIT_moveq(uint32_t *ptr, uint16_t **m68k_ptr, uint16_t *insn_consumed)
 {
     uint8_t update_mask = M68K_GetSRMask(*m68k_ptr);
-    uint16_t opcode = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     int8_t value = opcode & 0xff;
     uint8_t reg = (opcode >> 9) & 7;
     uint8_t tmp_reg = RA_MapM68kRegisterForWrite(&ptr, reg);
@@ -72,7 +72,7 @@ uint32_t GetSR_Line7(uint16_t opcode)
 uint32_t *EMIT_move(uint32_t *ptr, uint16_t **m68k_ptr, uint16_t *insn_consumed)
 {
     uint8_t update_mask = M68K_GetSRMask(*m68k_ptr);
-    uint16_t opcode = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     int move_length = M68K_GetINSNLength(*m68k_ptr);
     uint8_t ext_count = 0;
     uint8_t tmp_reg = 0xff;
@@ -142,7 +142,7 @@ uint32_t *EMIT_move(uint32_t *ptr, uint16_t **m68k_ptr, uint16_t *insn_consumed)
     if ((opcode & 0xf000) == 0x2000)
     {
         // Fetch 2nd opcode just now
-        uint16_t opcode2 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[1]);
+        uint16_t opcode2 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[1]);
 
         // Is move.l Reg, -(An) ?: Dest mode 100, source mode 000 or 001
         if ((opcode & 0x01f0) == 0x0100)
@@ -343,7 +343,7 @@ uint32_t *EMIT_move(uint32_t *ptr, uint16_t **m68k_ptr, uint16_t *insn_consumed)
         /* Only if target is data register */
         if ((tmp & 0x38) == 0)
         {
-            uint16_t opcode2 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[move_length - 1]);
+            uint16_t opcode2 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[move_length - 1]);
             
             /* Check if subsequent instruction is extb.l on the same target reg */
             if (size == 1 && (opcode2 & 0xfff8) == 0x49c0 && (opcode2 & 7) == (tmp & 7))
@@ -362,7 +362,7 @@ uint32_t *EMIT_move(uint32_t *ptr, uint16_t **m68k_ptr, uint16_t *insn_consumed)
             /* Check if subsequent instructions are ext.w + ext.l on the same target and size is byte */
             else if (size == 1 && (opcode2 & 0xfff8) == 0x4880 && (opcode2 & 7) == (tmp & 7))
             {
-                uint16_t opcode3 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[move_length]);
+                uint16_t opcode3 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[move_length]);
                 if ((opcode3 & 0xfff8) == 0x48c0 && (opcode3 & 7) == (tmp & 7))
                 {
                     sign_ext = 1;
@@ -424,10 +424,10 @@ uint32_t *EMIT_move(uint32_t *ptr, uint16_t **m68k_ptr, uint16_t *insn_consumed)
             is_load_immediate = 1;
             switch (size) {
                 case 4:
-                    immediate_value = cache_read_32(ICACHE, (uintptr_t)&(*(uint32_t*)(*m68k_ptr)));
+                    immediate_value = M68K_FetchLong((uintptr_t)&(*(uint32_t*)(*m68k_ptr)));
                     break;
                 case 2:
-                    immediate_value = cache_read_16(ICACHE, (uintptr_t)&(**m68k_ptr));
+                    immediate_value = M68K_FetchWord((uintptr_t)&(**m68k_ptr));
                     break;
                 case 1:
                     immediate_value = ((uint8_t*)*m68k_ptr)[1];
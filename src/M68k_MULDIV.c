@@ -116,7 +116,7 @@ uint32_t *EMIT_MULS_L(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
     uint8_t reg_dh = 0xff;
     uint8_t src = 0xff;
     uint8_t ext_words = 1;
-    uint16_t opcode2 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode2 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
 
     // Fetch 32-bit register: source and destination
     reg_dl = RA_MapM68kRegister(&ptr, (opcode2 >> 12) & 7);
@@ -202,7 +202,6 @@ uint32_t *EMIT_DIVS_W(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
     uint8_t ext_words = 0;
 
     ptr = EMIT_LoadFromEffectiveAddress(ptr, 0x80 | 2, &reg_q, opcode & 0x3f, *m68k_ptr, &ext_words, 0, NULL);
-    ptr = EMIT_FlushPC(ptr);
     RA_GetCC(&ptr);
 
     *ptr++ = ands_immed(31, reg_q, 16, 0);
@@ -214,7 +213,7 @@ uint32_t *EMIT_DIVS_W(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
         /*
             This is a point of no return. Issue division by zero exception here
         */
-        *ptr++ = add_immed(REG_PC, REG_PC, 2 * (ext_words + 1));
+        ptr = EMIT_SyncPC(ptr, 2 * (ext_words + 1));
 
         ptr = EMIT_Exception(ptr, VECTOR_DIVIDE_BY_ZERO, 2, (uint32_t)(intptr_t)(*m68k_ptr - 1));
 
@@ -312,7 +311,6 @@ uint32_t *EMIT_DIVU_W(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
 
     /* Promise read only here. If dealing with Dn in EA, it will be extended below */
     ptr = EMIT_LoadFromEffectiveAddress(ptr, 2, &reg_q, opcode & 0x3f, *m68k_ptr, &ext_words, 1, NULL);
-    ptr = EMIT_FlushPC(ptr);
     RA_GetCC(&ptr);
 
     *ptr++ = ands_immed(31, reg_q, 16, 0);
@@ -324,7 +322,7 @@ uint32_t *EMIT_DIVU_W(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
         /*
             This is a point of no return. Issue division by zero exception here
         */
-        *ptr++ = add_immed(REG_PC, REG_PC, 2 * (ext_words + 1));
+        ptr = EMIT_SyncPC(ptr, 2 * (ext_words + 1));
 
         ptr = EMIT_Exception(ptr, VECTOR_DIVIDE_BY_ZERO, 2, (uint32_t)(intptr_t)(*m68k_ptr - 1));
 
@@ -423,7 +421,7 @@ uint32_t *EMIT_DIVU_W(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
 uint32_t *EMIT_DIVUS_L(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
 {
     uint8_t update_mask = M68K_GetSRMask(*m68k_ptr - 1);
-    uint16_t opcode2 = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode2 = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     uint8_t sig = (opcode2 & (1 << 11)) != 0;
     uint8_t div64 = (opcode2 & (1 << 10)) != 0;
     uint8_t reg_q = 0xff;
@@ -433,7 +431,6 @@ uint32_t *EMIT_DIVUS_L(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
 
     // Load divisor
     ptr = EMIT_LoadFromEffectiveAddress(ptr, 4, &reg_q, opcode & 0x3f, *m68k_ptr, &ext_words, 1, NULL);
-    ptr = EMIT_FlushPC(ptr);
     RA_GetCC(&ptr);
 
     // Check if division by 0
@@ -445,7 +442,7 @@ uint32_t *EMIT_DIVUS_L(uint32_t *ptr, uint16_t opcode, uint16_t **m68k_ptr)
         /*
             This is a point of no return. Issue division by zero exception here
         */
-        *ptr++ = add_immed(REG_PC, REG_PC, 2 * (ext_words + 1));
+        ptr = EMIT_SyncPC(ptr, 2 * (ext_words + 1));
 
         ptr = EMIT_Exception(ptr, VECTOR_DIVIDE_BY_ZERO, 2, (uint32_t)(intptr_t)(*m68k_ptr - 1));
 
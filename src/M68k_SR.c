@@ -12,6 +12,49 @@
 #include "EmuFeatures.h"
 #include "cache.h"
 
+#define DECODE_WINDOW_SIZE  (JCCB_INSN_DEPTH_MASK + 1 + JC2_CCR_SCAN_MASK + 1)
+#define DECODE_WINDOW_WORDS 4096
+
+uint16_t *insn_window_base;
+uint32_t insn_window_size;
+uint16_t insn_window_words[DECODE_WINDOW_WORDS];
+/* Index + 1 of the instruction starting at given word of the window, 0 if none */
+static uint16_t insn_window_index[DECODE_WINDOW_WORDS];
+static struct DecodedInsn decoded[DECODE_WINDOW_SIZE];
+static int decoded_count;
+
+/* Find decoded instruction in the window */
+static int SR_FindInsn(uint16_t *insn_stream)
+{
+    uintptr_t offset = ((uintptr_t)insn_stream - (uintptr_t)insn_window_base) >> 1;
+
+    if (((uintptr_t)insn_stream & 1) == 0 && offset < insn_window_size)
+        return (int)insn_window_index[offset] - 1;
+
+    return -1;
+}
+
+int M68K_GetDecodedCount()
+{
+    return decoded_count;
+}
+
+struct DecodedInsn *M68K_GetDecodedInsn(int idx)
+{
+    return &decoded[idx];
+}
+
+int M68K_FindDecodedInsn(uint16_t *insn_stream)
+{
+    return SR_FindInsn(insn_stream);
+}
+
+void M68K_ReleaseDecodedUnit()
+{
+    insn_window_size = 0;
+    decoded_count = 0;
+}
+
 uint8_t SR_GetEALength(uint16_t *insn_stream, uint8_t ea, uint8_t imm_size)
 {
     uint8_t word_count = 0;
@@ -28,7 +71,7 @@ uint8_t SR_GetEALength(uint16_t *insn_stream, uint8_t ea, uint8_t imm_size)
         else if (mode == 6 || (mode == 7 && reg == 3))
         {
             /* Reg- or PC-relative addressing mode */
-            uint16_t brief = cache_read_16(ICACHE, (uint32_t)(uintptr_t)&insn_stream[0]);
+            uint16_t brief = M68K_FetchWord((uint32_t)(uintptr_t)&insn_stream[0]);
 
             /* Brief word is here */
             word_count++;
@@ -97,7 +140,12 @@ uint8_t SR_GetEALength(uint16_t *insn_stream, uint8_t ea, uint8_t imm_size)
 /* Check if opcode is of branch kind or may result in a */
 int M68K_IsBranch(uint16_t *insn_stream)
 {
-    uint16_t opcode = cache_read_16(ICACHE, (uint32_t)(uintptr_t)&insn_stream[0]);
+    int idx = SR_FindInsn(insn_stream);
+
+    if (idx >= 0)
+        return decoded[idx].di_Branch;
+
+    uint16_t opcode = M68K_FetchWord((uint32_t)(uintptr_t)&insn_stream[0]);
 
     if (
         opcode == 0x007c            ||
@@ -128,7 +176,7 @@ int M68K_IsBranch(uint16_t *insn_stream)
 
 int M68K_GetMoveLength(uint16_t *insn_stream)
 {
-    uint16_t opcode = cache_read_16(ICACHE, (uint32_t)(uintptr_t)&insn_stream[0]);
+    uint16_t opcode = M68K_FetchWord((uint32_t)(uintptr_t)&insn_stream[0]);
     int size = 0;
     int length = 1;
     uint8_t ea = opcode & 0x3f;
@@ -152,8 +200,8 @@ int M68K_GetMoveLength(uint16_t *insn_stream)
 
 int M68K_GetLineFLength(uint16_t *insn_stream)
 {
-    uint16_t opcode = cache_read_16(ICACHE, (uint32_t)(uintptr_t)&insn_stream[0]);
-    uint16_t opcode2 = cache_read_16(ICACHE, (uint32_t)(uintptr_t)&insn_stream[1]);;
+    uint16_t opcode = M68K_FetchWord((uint32_t)(uintptr_t)&insn_stream[0]);
+    uint16_t opcode2 = M68K_FetchWord((uint32_t)(uintptr_t)&insn_stream[1]);;
     int length = 1;
     int need_ea = 0;
     int opsize = 0;
@@ -763,15 +811,18 @@ int M68K_GetLineFLength(uint16_t *insn_stream)
         length += SR_GetEALength(&insn_stream[length], opcode & 0x3f, opsize * 2);
     }
 
-    kprintf("GetLineFLength for opcode %04x returns %d\n", opcode, 2*length);
-
     return length;
 }
 
 /* Get number of 16-bit words this instruction occupies */
 int M68K_GetINSNLength(uint16_t *insn_stream)
 {
-    uint16_t opcode = cache_read_16(ICACHE, (uint32_t)(uintptr_t)&insn_stream[0]);
+    int idx = SR_FindInsn(insn_stream);
+
+    if (idx >= 0)
+        return decoded[idx].di_Length;
+
+    uint16_t opcode = M68K_FetchWord((uint32_t)(uintptr_t)&insn_stream[0]);
     int length = 0;
 
     switch(opcode & 0xf000)
@@ -857,17 +908,252 @@ static SR_Check SRCheck[16] = {
 };
 
 extern struct M68KState *__m68k_state;
+extern int var_EMU68_CCR_SCAN_DEPTH;
+
+/*
+    Follow one path of a conditional branch. Returns the flags from mask which are needed on the path,
+    or which could not be proven dead before the scan stopped
+*/
+static uint8_t SR_ScanPath(uint16_t *insn_stream, uint8_t mask, int scan_depth, int max_scan_depth)
+{
+    uint8_t needed = 0;
+
+    while(mask && scan_depth < max_scan_depth)
+    {
+        scan_depth++;
+
+        /* If instruction is a branch break the scan */
+        if (M68K_IsBranch(insn_stream))
+            break;
+
+        /* Get opcode */
+        uint16_t opcode = M68K_FetchWord((uint32_t)(uintptr_t)insn_stream);
+
+        D(kprintf("[JIT]   %02d.p: opcode=%04x @ %08x ", scan_depth, opcode, insn_stream));
+
+        uint32_t flags = SRCheck[opcode >> 12](opcode);
+        uint8_t tmp_sets = flags & 0x1f;
+        uint8_t tmp_needs = (flags >> 16) & 0x1f;
+
+        D(kprintf(" SRNeeds = %x, SRSets = %x\n", tmp_needs, tmp_sets));
+
+        /* If instruction *needs* one of flags from current opcode, break the check and return mask */
+        if (mask & tmp_needs) {
+            needed |= (mask & tmp_needs);
+        }
+
+        /* Clear flags which this instruction sets */
+        mask = mask & ~tmp_sets;
+
+        if ((mask & tmp_needs) == mask) {
+            break;
+        }
+
+        /* Advance to subsequent instruction */
+        insn_stream += M68K_GetINSNLength(insn_stream);
+    }
+
+    return mask | needed;
+}
+
+/* Get target of a PC-relative branch together with address of the instruction following it */
+static uint16_t *SR_BranchTarget(uint16_t *insn_stream, uint16_t **next)
+{
+    uint16_t opcode = M68K_FetchWord((uint32_t)(uintptr_t)insn_stream);
+    int32_t branch_offset = (int8_t)(opcode & 0xff);
+    uint16_t *insn_stream_2 = insn_stream + 1;
+
+    if ((opcode & 0xff) == 0) {
+        branch_offset = (int16_t)M68K_FetchWord((uint32_t)(uintptr_t)&insn_stream[1]);
+        insn_stream_2++;
+    } else if ((opcode & 0xff) == 0xff) {
+        uint16_t lo16, hi16;
+        hi16 = M68K_FetchWord((uint32_t)(uintptr_t)&insn_stream[1]);
+        lo16 = M68K_FetchWord((uint32_t)(uintptr_t)&insn_stream[2]);
+        branch_offset = lo16 | (hi16 << 16);
+        insn_stream_2+=2;
+    }
+
+    if (next)
+        *next = insn_stream_2;
+
+    return insn_stream + 1 + (branch_offset >> 1);
+}
+
+/* Link successor of the instruction, flags live at successors outside of the window are scanned for */
+static int16_t SR_LinkSuccessor(struct DecodedInsn *insn, uint16_t *succ)
+{
+    int found;
+
+    if (succ == NULL)
+        return -1;
+
+    found = SR_FindInsn(succ);
+
+    if (found < 0)
+        insn->di_LiveExt |= SR_ScanPath(succ, SR_CCR, 0, var_EMU68_CCR_SCAN_DEPTH);
+
+    return found;
+}
+
+/*
+    Decode the straight line code following entry of the unit being translated. Instruction words are
+    copied into the window, so that the emitters do not need to read them through the cache again.
+    Then liveness of status flags is computed with a backward pass over the decoded instructions.
+*/
+void M68K_DecodeUnit(uint16_t *insn_stream, int depth)
+{
+    int changed;
+
+    M68K_ReleaseDecodedUnit();
+
+    insn_window_base = insn_stream;
+
+    if (depth > DECODE_WINDOW_SIZE)
+        depth = DECODE_WINDOW_SIZE;
+
+    /* Decode straight line code, stop after any instruction which does not fall through */
+    while (decoded_count < depth)
+    {
+        uint16_t opcode = M68K_FetchWord((uint32_t)(uintptr_t)insn_stream);
+        uint32_t flags = SRCheck[opcode >> 12](opcode);
+        int length = M68K_GetINSNLength(insn_stream);
+        int branch = M68K_IsBranch(insn_stream);
+        struct DecodedInsn *insn = &decoded[decoded_count];
+
+        if (length <= 0 || insn_window_size + length > DECODE_WINDOW_WORDS)
+            break;
+
+        for (int i=0; i < length; i++)
+        {
+            insn_window_words[insn_window_size + i] = cache_read_16(ICACHE, (uint32_t)(uintptr_t)&insn_stream[i]);
+            insn_window_index[insn_window_size + i] = 0;
+        }
+        insn_window_index[insn_window_size] = ++decoded_count;
+        insn_window_size += length;
+
+        insn->di_Insn = insn_stream;
+        insn->di_Next = insn_stream + length;
+        insn->di_Target = NULL;
+        insn->di_Length = length;
+        insn->di_Branch = branch;
+        insn->di_Sets = flags & 0x1f;
+        insn->di_Needs = (flags >> 16) & 0x1f;
+        insn->di_LiveIn = 0;
+        insn->di_LiveExt = 0;
+
+        if (insn->di_Branch)
+        {
+            /* Bcc has two successors, BRA and BSR only the target */
+            if ((opcode & 0xf000) == 0x6000)
+            {
+                insn->di_Target = SR_BranchTarget(insn_stream, NULL);
+                if ((opcode & 0xfe00) == 0x6000)
+                    insn->di_Next = NULL;
+            }
+            /* JMP/JSR to absolute address */
+            else if ((opcode & 0xffbe) == 0x4eb8)
+            {
+                if (opcode & 1) {
+                    insn->di_Target = (uint16_t*)(uintptr_t)M68K_FetchLong((uint32_t)(uintptr_t)&insn_stream[1]);
+                } else {
+                    insn->di_Target = (uint16_t*)(uintptr_t)(uint32_t)(int16_t)M68K_FetchWord((uint32_t)(uintptr_t)&insn_stream[1]);
+                }
+                insn->di_Next = NULL;
+            }
+            /* Successor not known, all flags may be needed */
+            else
+            {
+                insn->di_LiveExt = SR_CCR;
+                insn->di_Next = NULL;
+            }
+        }
+
+        if (insn->di_Next == NULL)
+            break;
+
+        insn_stream = insn->di_Next;
+    }
+
+    for (int i=0; i < decoded_count; i++)
+    {
+        decoded[i].di_NextIdx = SR_LinkSuccessor(&decoded[i], decoded[i].di_Next);
+        decoded[i].di_TargetIdx = SR_LinkSuccessor(&decoded[i], decoded[i].di_Target);
+    }
+
+    /* CCR optimization disabled, every flag is live */
+    if (var_EMU68_CCR_SCAN_DEPTH == 0)
+    {
+        for (int i=0; i < decoded_count; i++)
+            decoded[i].di_LiveOut = SR_CCR;
+
+        return;
+    }
+
+    /* Backward pass. Repeated only if a branch backwards made flags live in already visited code */
+    do
+    {
+        changed = 0;
+
+        for (int i=decoded_count - 1; i >= 0; --i)
+        {
+            struct DecodedInsn *insn = &decoded[i];
+            uint8_t live_out = insn->di_LiveExt;
+            uint8_t live_in;
+
+            if (insn->di_NextIdx >= 0)
+                live_out |= decoded[insn->di_NextIdx].di_LiveIn;
+            if (insn->di_TargetIdx >= 0)
+                live_out |= decoded[insn->di_TargetIdx].di_LiveIn;
+
+            live_in = insn->di_Needs | (live_out & ~insn->di_Sets);
+
+            insn->di_LiveOut = live_out;
+            if (live_in != insn->di_LiveIn)
+            {
+                insn->di_LiveIn = live_in;
+                changed = 1;
+            }
+        }
+    } while (changed);
+
+    D(kprintf("[JIT] Decoded %d instructions, %d words\n", decoded_count, insn_window_size));
+}
+
+/*
+    Get the mask of flags from the given set which are needed by any of the two paths following the
+    conditional branch. The flags which the branch tests itself are not included
+*/
+uint8_t M68K_GetSRMaskAfterBranch(uint16_t *insn_stream, uint8_t mask)
+{
+    uint16_t *insn_stream_2;
+    uint16_t *target;
+    int idx = SR_FindInsn(insn_stream);
+
+    if (idx >= 0)
+        return mask & decoded[idx].di_LiveOut;
+
+    target = SR_BranchTarget(insn_stream, &insn_stream_2);
+
+    return SR_ScanPath(target, mask, 0, var_EMU68_CCR_SCAN_DEPTH) |
+           SR_ScanPath(insn_stream_2, mask, 0, var_EMU68_CCR_SCAN_DEPTH);
+}
 
 /* Get the mask of status flags changed by the instruction specified by the opcode */
 uint8_t M68K_GetSRMask(uint16_t *insn_stream)
 {
-    uint16_t opcode = cache_read_16(ICACHE, (uint32_t)(uintptr_t)insn_stream);
+    uint16_t opcode = M68K_FetchWord((uint32_t)(uintptr_t)insn_stream);
     int scan_depth = 0;
-    const int max_scan_depth = (__m68k_state->JIT_CONTROL2 >> JC2B_CCR_SCAN_DEPTH) & JC2_CCR_SCAN_MASK;
+    const int max_scan_depth = var_EMU68_CCR_SCAN_DEPTH;
     uint8_t mask = 0;
     uint8_t needed = 0;
     uint8_t tmp_sets = 0;
     uint8_t tmp_needs = 0;
+    int idx = SR_FindInsn(insn_stream);
+
+    /* Instruction within liveness window of the unit, use precomputed mask */
+    if (idx >= 0)
+        return decoded[idx].di_Sets & decoded[idx].di_LiveOut;
 
     D(kprintf("[JIT] GetSRMask, opcode %04x @ %08x, ", opcode, insn_stream));
 
@@ -896,11 +1182,11 @@ uint8_t M68K_GetSRMask(uint16_t *insn_stream)
                 int32_t branch_offset = (int8_t)(opcode & 0xff);
 
                 if ((opcode & 0xff) == 0) {
-                    branch_offset = (int16_t)cache_read_16(ICACHE, (uint32_t)(uintptr_t)&insn_stream[1]);
+                    branch_offset = (int16_t)M68K_FetchWord((uint32_t)(uintptr_t)&insn_stream[1]);
                 } else if ((opcode & 0xff) == 0xff) {
                     uint16_t lo16, hi16;
-                    hi16 = cache_read_16(ICACHE, (uint32_t)(uintptr_t)&insn_stream[1]);
-                    lo16 = cache_read_16(ICACHE, (uint32_t)(uintptr_t)&insn_stream[2]);
+                    hi16 = M68K_FetchWord((uint32_t)(uintptr_t)&insn_stream[1]);
+                    lo16 = M68K_FetchWord((uint32_t)(uintptr_t)&insn_stream[2]);
                     branch_offset = lo16 | (hi16 << 16);
                 }
 
@@ -913,11 +1199,11 @@ uint8_t M68K_GetSRMask(uint16_t *insn_stream)
             {
                 if (opcode & 1) {
                     uint16_t lo16, hi16;
-                    hi16 = cache_read_16(ICACHE, (uint32_t)(uintptr_t)&insn_stream[1]);
-                    lo16 = cache_read_16(ICACHE, (uint32_t)(uintptr_t)&insn_stream[2]);
+                    hi16 = M68K_FetchWord((uint32_t)(uintptr_t)&insn_stream[1]);
+                    lo16 = M68K_FetchWord((uint32_t)(uintptr_t)&insn_stream[2]);
                     insn_stream = (uint16_t*)(uintptr_t)(lo16 | (hi16 << 16));
                 } else {
-                    insn_stream = (uint16_t*)(uintptr_t)((uint32_t)cache_read_16(ICACHE, (uint32_t)(uintptr_t)&insn_stream[1]));
+                    insn_stream = (uint16_t*)(uintptr_t)(uint32_t)(int16_t)M68K_FetchWord((uint32_t)(uintptr_t)&insn_stream[1]);
                 }
 
                 D(kprintf("[JIT]   %02d: Absolute jump to %08x\n", scan_depth, insn_stream));
@@ -931,12 +1217,12 @@ uint8_t M68K_GetSRMask(uint16_t *insn_stream)
                 needed |= mask & (SRCheck[opcode >> 12](opcode) >> 16);
 
                 if ((opcode & 0xff) == 0) {
-                    branch_offset = (int16_t)cache_read_16(ICACHE, (uint32_t)(uintptr_t)&insn_stream[1]);
+                    branch_offset = (int16_t)M68K_FetchWord((uint32_t)(uintptr_t)&insn_stream[1]);
                     insn_stream_2++;
                 } else if ((opcode & 0xff) == 0xff) {
                     uint16_t lo16, hi16;
-                    hi16 = cache_read_16(ICACHE, (uint32_t)(uintptr_t)&insn_stream[1]);
-                    lo16 = cache_read_16(ICACHE, (uint32_t)(uintptr_t)&insn_stream[2]);
+                    hi16 = M68K_FetchWord((uint32_t)(uintptr_t)&insn_stream[1]);
+                    lo16 = M68K_FetchWord((uint32_t)(uintptr_t)&insn_stream[2]);
                     branch_offset = lo16 | (hi16 << 16);
                     insn_stream_2+=2;
                 }
@@ -945,87 +1231,12 @@ uint8_t M68K_GetSRMask(uint16_t *insn_stream)
 
                 D(kprintf("[JIT]   %02d: Splitting into two paths %08x and %08x\n", scan_depth, insn_stream, insn_stream_2));
 
-                uint8_t mask1 = mask;
-                uint8_t mask2 = mask;
-                uint8_t needed1 = needed;
-                uint8_t needed2 = needed;
-                int scan_depth_tmp = scan_depth;
-
-                while(mask1 && scan_depth < max_scan_depth)
-                {
-                    scan_depth++;
-
-                    /* If instruction is a branch break the scan */
-                    if (M68K_IsBranch(insn_stream))
-                        break;
-
-                    /* Get opcode */
-                    opcode = cache_read_16(ICACHE, (uint32_t)(uintptr_t)insn_stream);
-
-                    D(kprintf("[JIT]   %02d.1: opcode=%04x @ %08x ", scan_depth, opcode, insn_stream));
-
-                    uint32_t flags = SRCheck[opcode >> 12](opcode);
-                    tmp_sets = flags & 0x1f;
-                    tmp_needs = (flags >> 16) & 0x1f;
-
-                    D(kprintf(" SRNeeds = %x, SRSets = %x\n", tmp_needs, tmp_sets));
-
-                    /* If instruction *needs* one of flags from current opcode, break the check and return mask */
-                    if (mask1 & tmp_needs) {
-                        needed1 |= (mask1 & tmp_needs);
-                    }
-
-                    /* Clear flags which this instruction sets */
-                    mask1 = mask1 & ~tmp_sets;
-
-                    if ((mask1 & tmp_needs) == mask1) {
-                        break;
-                    }
-
-                    /* Advance to subsequent instruction */
-                    insn_stream += M68K_GetINSNLength(insn_stream);
-                }
-
-                scan_depth = scan_depth_tmp;
-
-                while(mask2 && scan_depth < max_scan_depth)
-                {
-                    scan_depth++;
-
-                    /* If instruction is a branch break the scan */
-                    if (M68K_IsBranch(insn_stream_2))
-                        break;
-
-                    /* Get opcode */
-                    opcode = cache_read_16(ICACHE, (uint32_t)(uintptr_t)insn_stream_2);
-
-                    D(kprintf("[JIT]   %02d.2: opcode=%04x @ %08x ", scan_depth, opcode, insn_stream_2));
-
-                    uint32_t flags = SRCheck[opcode >> 12](opcode);
-                    tmp_sets = flags & 0x1f;
-                    tmp_needs = (flags >> 16) & 0x1f;
-
-                    D(kprintf(" SRNeeds = %x, SRSets = %x\n", tmp_needs, tmp_sets));
-
-                    /* If instruction *needs* one of flags from current opcode, break the check and return mask */
-                    if (mask2 & tmp_needs) {
-                        needed2 |= (mask2 & tmp_needs);
-                    }
-
-                    /* Clear flags which this instruction sets */
-                    mask2 = mask2 & ~tmp_sets;
-
-                    if ((mask2 & tmp_needs) == mask2) {
-                        break;
-                    }
-
-                    /* Advance to subsequent instruction */
-                    insn_stream_2 += M68K_GetINSNLength(insn_stream_2);
-                }
+                uint8_t mask1 = SR_ScanPath(insn_stream, mask, scan_depth, max_scan_depth);
+                uint8_t mask2 = SR_ScanPath(insn_stream_2, mask, scan_depth, max_scan_depth);
 
-                D(kprintf("[JIT]   joining masks %x and %x to %x\n", mask1 | needed1, mask2 | needed2, mask1 | needed1 | mask2 | needed2));
+                D(kprintf("[JIT]   joining masks %x and %x to %x\n", mask1 | needed, mask2 | needed, mask1 | mask2 | needed));
 
-                return mask1 | needed1 | mask2 | needed2;
+                return mask1 | mask2 | needed;
             }
             else 
             {
@@ -1040,7 +1251,7 @@ uint8_t M68K_GetSRMask(uint16_t *insn_stream)
         }
         
         /* Get opcode */
-        opcode = cache_read_16(ICACHE, (uint32_t)(uintptr_t)insn_stream);
+        opcode = M68K_FetchWord((uint32_t)(uintptr_t)insn_stream);
         D(kprintf("[JIT]   %02d: opcode=%04x @ %08x ", scan_depth, opcode, insn_stream));
 
         uint32_t flags = SRCheck[opcode >> 12](opcode);
@@ -19,6 +19,7 @@
 #include "DuffCopy.h"
 #include "disasm.h"
 #include "cache.h"
+#include "mmu.h"
 
 #if SET_FEATURES_AT_RUNTIME
 features_t Features;
@@ -43,11 +44,75 @@ static inline int globalDisasm() {
     return disasm;
 }
 
-struct List ICache[EMU68_HASHSIZE];
+struct M68KUnitSlot UnitTable[EMU68_UNIT_TABLE_SIZE] __attribute__((aligned(64)));
+/* Number of slots holding a unit and slots freed by removal which still continue probe sequences */
+static uint32_t unit_table_used;
+static uint32_t unit_table_deleted;
+/* Units overlapping 4KB m68k pages, hashed by page number, and units spanning too many pages */
+static struct List PageUnits[EMU68_PAGE_HASHSIZE];
+static struct List WideUnits;
 struct List LRU;
 static uint32_t *temporary_arm_code;
+/* Buffer for code which does not become a unit, see M68K_TranslateNoCache */
+static uint32_t *scratch_arm_code;
 static struct M68KLocalState *local_state;
 
+#define MAX_UNIT_LINKS  (JCCB_INSN_DEPTH_MASK + 2)
+
+/* Links waiting for their target unit, hashed by m68k target address */
+static struct List PendingLinks[EMU68_LINK_HASHSIZE];
+/* Exits of the unit being translated, recorded as offsets into temporary_arm_code */
+static uint32_t link_count;
+static uint32_t link_offset[MAX_UNIT_LINKS];
+static uint16_t *link_target[MAX_UNIT_LINKS];
+/* m68k instruction which emitted the exit and offset of its exit counter code, if any */
+static uint16_t *link_source[MAX_UNIT_LINKS];
+static uint32_t link_counter[MAX_UNIT_LINKS];
+/* m68k instruction being translated, NULL while the final exit of the unit is emitted */
+static uint16_t *exit_source;
+/* Tier of the unit being translated, see M68K_Translate */
+static int translation_tier;
+/* Static target of the last emitted instruction if it ended the unit, NULL otherwise */
+static uint16_t *exit_target;
+/* Set if the last emitted instruction ended the unit with a computed jump */
+static int exit_indirect;
+/* Set if the last emitted instruction ended the unit with RTS not predicted during translation */
+static int exit_return;
+/* Call site pushing on runtime return stack: adr instruction to fix and the return address */
+static uint32_t *return_slot_adr;
+static uint8_t return_slot_reg;
+static uint16_t *return_slot_pc;
+
+/* Odd m68k address never matching any PC, used for free entries of inline branch cache */
+#define BRANCH_CACHE_EMPTY  ((uint16_t *)1)
+
+#if EMU68_SIDE_ENTRIES
+/* Odd m68k address marking the link of a unit branching into side entry of another unit */
+#define SIDE_ENTRY_LINK     ((uint16_t *)3)
+
+/* Side entries of the unit being translated, m68k offsets are filled once the unit range is known */
+static uint32_t entry_count;
+static uint16_t *entry_m68k[EMU68_UNIT_MAX_ENTRIES];
+static struct M68KSideEntry entry_state[EMU68_UNIT_MAX_ENTRIES];
+/* Unit entered by the side entry unit being created, it must not be evicted meanwhile */
+static struct M68KTranslationUnit *entry_owner;
+#endif
+
+#if EMU68_LAZY_PC
+/*
+    Offset of m68k PC not yet added to the PC register may grow up to the range of a single add or
+    sub immediate. Exceptions bring the register up to date on their own path, see EMIT_SyncPC, and
+    m68k PC of faulting code is taken from the PC map of the unit.
+*/
+#define PC_REL_LIMIT    4000
+
+/* PC map of the unit being translated */
+static uint32_t pc_map_count;
+static struct M68KPCMap pc_map[JCCB_INSN_DEPTH_MASK + 1];
+#else
+#define PC_REL_LIMIT    120
+#endif
+
 int32_t _pc_rel = 0;
 
 uint32_t *EMIT_GetOffsetPC(uint32_t *ptr, int8_t *offset)
@@ -79,7 +144,7 @@ uint32_t *EMIT_AdvancePC(uint32_t *ptr, uint8_t offset)
     _pc_rel += (int)offset;
 
     // If overflow would occur then compute PC and get new offset
-    if (_pc_rel > 120 || _pc_rel < -120)
+    if (_pc_rel > PC_REL_LIMIT || _pc_rel < -PC_REL_LIMIT)
     {
         if (_pc_rel > 0)
             *ptr++ = add_immed(REG_PC, REG_PC, _pc_rel);
@@ -104,6 +169,22 @@ uint32_t *EMIT_FlushPC(uint32_t *ptr)
     return ptr;
 }
 
+/*
+    Set the PC register offset bytes past current m68k PC on a path which leaves the unit, e.g. an
+    exception. Code continuing behind the path keeps the PC lazy.
+*/
+uint32_t *EMIT_SyncPC(uint32_t *ptr, int32_t offset)
+{
+    offset += _pc_rel;
+
+    if (offset > 0)
+        *ptr++ = add_immed(REG_PC, REG_PC, offset);
+    else if (offset < 0)
+        *ptr++ = sub_immed(REG_PC, REG_PC, -offset);
+
+    return ptr;
+}
+
 uint32_t *EMIT_ResetOffsetPC(uint32_t *ptr)
 {
     _pc_rel = 0;
@@ -112,7 +193,7 @@ uint32_t *EMIT_ResetOffsetPC(uint32_t *ptr)
 
 uint32_t *EMIT_lineA(uint32_t *arm_ptr, uint16_t **m68k_ptr, uint16_t *insn_consumed)
 {
-    uint16_t opcode = cache_read_16(ICACHE, (uintptr_t)&(*m68k_ptr)[0]);
+    uint16_t opcode = M68K_FetchWord((uintptr_t)&(*m68k_ptr)[0]);
     (*m68k_ptr)++;
     (*insn_consumed)++;
 
@@ -149,7 +230,7 @@ extern struct M68KState *__m68k_state;
 static inline uint32_t *EmitINSN(uint32_t *arm_ptr, uint16_t **m68k_ptr, uint16_t *insn_consumed)
 {
     uint32_t *ptr = arm_ptr;
-    uint16_t opcode = cache_read_16(ICACHE, (uint32_t)(uintptr_t)*m68k_ptr);
+    uint16_t opcode = M68K_FetchWord((uint32_t)(uintptr_t)*m68k_ptr);
     uint8_t group = opcode >> 12;
 
     if (debug > 2)
@@ -253,7 +334,292 @@ uint8_t reg_Load96;
 uint8_t reg_Save96;
 uint32_t val_FPIAR;
 
+void M68K_SetExitTarget(uint16_t *m68k_target)
+{
+    exit_target = m68k_target;
+}
+
+/*
+    Emit return to the dispatcher. If the m68k target is known at translation time, the
+    return is preceded by a check for pending interrupts and enabled instruction cache,
+    followed by a slot which M68K_LinkUnit will later patch into direct branch to the
+    successor unit. Until then the slot is a plain return.
+*/
+static uint32_t *EMIT_ChainExit(uint32_t *ptr, uint16_t *m68k_target)
+{
+#if EMU68_BLOCK_CHAINING
+    if (m68k_target != NULL && link_count < MAX_UNIT_LINKS && (__m68k_state->JIT_CONTROL2 & JC2F_CHAIN_UNITS))
+    {
+        uint8_t tmp = RA_AllocARMRegister(&ptr);
+
+        link_counter[link_count] = 0;
+        link_source[link_count] = exit_source;
+
+#if EMU68_TIERED_JIT
+        /*
+            First tier unit counts how often it is left through this exit. The adr gets the address
+            of ml_Count in the link record once the unit is allocated.
+        */
+        if (translation_tier == 1 && exit_source != NULL)
+        {
+            uint8_t tmp2 = RA_AllocARMRegister(&ptr);
+
+            link_counter[link_count] = ptr - temporary_arm_code;
+            *ptr++ = adr(tmp, 0);
+            *ptr++ = bic64_immed(tmp, tmp, 1, 64 - 36, 1);
+            *ptr++ = ldr_offset(tmp, tmp2, 0);
+            *ptr++ = add_immed(tmp2, tmp2, 1);
+            *ptr++ = str_offset(tmp, tmp2, 0);
+
+            RA_FreeARMRegister(&ptr, tmp2);
+        }
+#endif
+
+        *ptr++ = mrs(tmp, 3, 3, 13, 0, 3);
+        *ptr++ = ldr_offset(tmp, tmp, __builtin_offsetof(struct M68KState, INT32));
+        *ptr++ = cbnz(tmp, 4);
+        *ptr++ = mov_simd_to_reg(tmp, 31, TS_S, 0);
+        *ptr++ = tbz(tmp, CACRB_IE, 2);
+
+        link_offset[link_count] = ptr - temporary_arm_code;
+        link_target[link_count] = m68k_target;
+        link_count++;
+
+        *ptr++ = bx_lr();
+
+        RA_FreeARMRegister(&ptr, tmp);
+    }
+#else
+    (void)m68k_target;
+#endif
+
+    *ptr++ = bx_lr();
+
+    return ptr;
+}
+
+void M68K_SetIndirectExit()
+{
+    exit_indirect = 1;
+}
+
+/*
+    Emit return to the dispatcher after a computed jump (JMP/JSR). The target PC is compared
+    against two m68k addresses cached inline in the code. On a hit the code branches through
+    the corresponding slot, which is chained with the target unit just like the static exits
+    are. On a miss the address of the site is left in JIT_BRANCH_SITE of the context, so that
+    the dispatcher can update the cache once it finds the target unit.
+
+    Layout of the site following the miss path:
+        slot0, slot1        - return or branch to cached units
+        pc0, pc1            - cached m68k addresses (data)
+        site                - 64-bit pointer to the link record of slot0 (data)
+*/
+static uint32_t *EMIT_BranchCacheExit(uint32_t *ptr)
+{
+#if EMU68_BRANCH_CACHE
+    if (link_count + 2 <= MAX_UNIT_LINKS && (__m68k_state->JIT_CONTROL2 & JC2F_BRANCH_CACHE))
+    {
+        uint8_t ctx = RA_AllocARMRegister(&ptr);
+        uint8_t tmp = RA_AllocARMRegister(&ptr);
+        uint32_t *exit_1, *exit_2, *hit_0, *hit_1, *load_0, *load_1, *load_site, *exit;
+        uint32_t *slot;
+
+        *ptr++ = mrs(ctx, 3, 3, 13, 0, 3);
+        *ptr++ = ldr_offset(ctx, tmp, __builtin_offsetof(struct M68KState, INT32));
+        exit_1 = ptr;
+        *ptr++ = cbnz(tmp, 0);
+        *ptr++ = mov_simd_to_reg(tmp, 31, TS_S, 0);
+        exit_2 = ptr;
+        *ptr++ = tbz(tmp, CACRB_IE, 0);
+        load_0 = ptr;
+        *ptr++ = ldr_pcrel(tmp, 0);
+        *ptr++ = cmp_reg(REG_PC, tmp, LSL, 0);
+        hit_0 = ptr;
+        *ptr++ = b_cc(A64_CC_EQ, 0);
+        load_1 = ptr;
+        *ptr++ = ldr_pcrel(tmp, 0);
+        *ptr++ = cmp_reg(REG_PC, tmp, LSL, 0);
+        hit_1 = ptr;
+        *ptr++ = b_cc(A64_CC_EQ, 0);
+        load_site = ptr;
+        *ptr++ = ldr64_pcrel(tmp, 0);
+        *ptr++ = str64_offset(ctx, tmp, __builtin_offsetof(struct M68KState, JIT_BRANCH_SITE));
+        exit = ptr;
+        *ptr++ = bx_lr();
+
+        /* Align the site pointer to 8 bytes */
+        if ((ptr - temporary_arm_code) & 1)
+            *ptr++ = nop();
+
+        slot = ptr;
+        for (int i=0; i < 2; i++)
+        {
+            link_offset[link_count] = ptr - temporary_arm_code;
+            link_target[link_count] = BRANCH_CACHE_EMPTY;
+            link_source[link_count] = NULL;
+            link_counter[link_count] = 0;
+            link_count++;
+            *ptr++ = bx_lr();
+        }
+        *ptr++ = (uint32_t)(uintptr_t)BRANCH_CACHE_EMPTY;
+        *ptr++ = (uint32_t)(uintptr_t)BRANCH_CACHE_EMPTY;
+        /* Site pointer is filled when the unit is put into the cache */
+        *ptr++ = 0;
+        *ptr++ = 0;
+
+        *exit_1 = cbnz(tmp, exit - exit_1);
+        *exit_2 = tbz(tmp, CACRB_IE, exit - exit_2);
+        *load_0 = ldr_pcrel(tmp, &slot[2] - load_0);
+        *load_1 = ldr_pcrel(tmp, &slot[3] - load_1);
+        *load_site = ldr64_pcrel(tmp, &slot[4] - load_site);
+        *hit_0 = b_cc(A64_CC_EQ, &slot[0] - hit_0);
+        *hit_1 = b_cc(A64_CC_EQ, &slot[1] - hit_1);
+
+        RA_FreeARMRegister(&ptr, tmp);
+        RA_FreeARMRegister(&ptr, ctx);
+
+        return ptr;
+    }
+#endif
+
+    *ptr++ = bx_lr();
+
+    return ptr;
+}
+
+void M68K_SetReturnExit()
+{
+    exit_return = 1;
+}
+
+/*
+    Runtime return stack. BSR and JSR which end the translation unit push the m68k return
+    address together with the address of a slot emitted at the end of the unit. The slot is a
+    regular unit link targeting the return address. RTS which could not be predicted during
+    translation pops the entry and, if the return address matches, branches through the slot
+    instead of going back to the dispatcher.
+*/
+uint32_t *EMIT_PushReturnStack(uint32_t *ptr, uint16_t *ret_addr)
+{
+#if EMU68_SHADOW_RETURN_STACK
+    if (__m68k_state->JIT_CONTROL2 & JC2F_RETURN_STACK)
+    {
+        uint8_t ctx = RA_GetCTX(&ptr);
+        uint8_t top = RA_AllocARMRegister(&ptr);
+        uint8_t tmp = RA_AllocARMRegister(&ptr);
+        uint32_t ret = (uint32_t)(uintptr_t)ret_addr;
+
+        *ptr++ = ldr_offset(ctx, top, __builtin_offsetof(struct M68KState, JIT_RETURN_TOP));
+        *ptr++ = ldr_offset(ctx, tmp, __builtin_offsetof(struct M68KState, JIT_RETURN_DEPTH));
+        *ptr++ = add_immed(top, top, 1);
+        *ptr++ = and_immed(top, top, __builtin_ctz(JIT_RETURN_STACK_SIZE), 0);
+        *ptr++ = cmp_immed(tmp, JIT_RETURN_STACK_SIZE);
+        *ptr++ = csinc(tmp, tmp, tmp, A64_CC_CS);
+        *ptr++ = str_offset(ctx, top, __builtin_offsetof(struct M68KState, JIT_RETURN_TOP));
+        *ptr++ = str_offset(ctx, tmp, __builtin_offsetof(struct M68KState, JIT_RETURN_DEPTH));
+        *ptr++ = add64_reg(top, ctx, top, LSL, 4);
+        *ptr++ = mov_immed_u16(tmp, ret & 0xffff, 0);
+        *ptr++ = movk_immed_u16(tmp, ret >> 16, 1);
+        *ptr++ = str_offset(top, tmp, __builtin_offsetof(struct M68KState, JIT_RETURN_STACK[0].M68K));
+
+        /* Address of the slot is known once the unit is complete */
+        return_slot_adr = ptr;
+        return_slot_reg = tmp;
+        return_slot_pc = ret_addr;
+        *ptr++ = adr(tmp, 0);
+        *ptr++ = str64_offset(top, tmp, __builtin_offsetof(struct M68KState, JIT_RETURN_STACK[0].ARM));
+
+        RA_FreeARMRegister(&ptr, tmp);
+        RA_FreeARMRegister(&ptr, top);
+    }
+#else
+    (void)ret_addr;
+#endif
+
+    return ptr;
+}
+
+/* Drop all return stack entries. If ctx is 0xff, context pointer is fetched into temporary register */
+uint32_t *EMIT_ResetReturnStack(uint32_t *ptr, uint8_t ctx)
+{
+#if EMU68_SHADOW_RETURN_STACK
+    if (ctx == 0xff)
+    {
+        uint8_t tmp = RA_AllocARMRegister(&ptr);
+        *ptr++ = mrs(tmp, 3, 3, 13, 0, 3);
+        *ptr++ = str_offset(tmp, 31, __builtin_offsetof(struct M68KState, JIT_RETURN_DEPTH));
+        RA_FreeARMRegister(&ptr, tmp);
+    }
+    else
+    {
+        *ptr++ = str_offset(ctx, 31, __builtin_offsetof(struct M68KState, JIT_RETURN_DEPTH));
+    }
+#else
+    (void)ctx;
+#endif
+
+    return ptr;
+}
+
+static uint32_t *EMIT_ReturnStackExit(uint32_t *ptr)
+{
+#if EMU68_SHADOW_RETURN_STACK
+    if (__m68k_state->JIT_CONTROL2 & JC2F_RETURN_STACK)
+    {
+        uint8_t ctx = RA_AllocARMRegister(&ptr);
+        uint8_t top = RA_AllocARMRegister(&ptr);
+        uint8_t tmp = RA_AllocARMRegister(&ptr);
+        uint32_t *exit_1, *exit_2, *exit_3, *exit_4;
+
+        *ptr++ = mrs(ctx, 3, 3, 13, 0, 3);
+        *ptr++ = ldr_offset(ctx, tmp, __builtin_offsetof(struct M68KState, JIT_RETURN_DEPTH));
+        exit_1 = ptr;
+        *ptr++ = cbz(tmp, 0);
+        *ptr++ = sub_immed(tmp, tmp, 1);
+        *ptr++ = str_offset(ctx, tmp, __builtin_offsetof(struct M68KState, JIT_RETURN_DEPTH));
+        *ptr++ = ldr_offset(ctx, tmp, __builtin_offsetof(struct M68KState, JIT_RETURN_TOP));
+        *ptr++ = add64_reg(top, ctx, tmp, LSL, 4);
+        *ptr++ = sub_immed(tmp, tmp, 1);
+        *ptr++ = and_immed(tmp, tmp, __builtin_ctz(JIT_RETURN_STACK_SIZE), 0);
+        *ptr++ = str_offset(ctx, tmp, __builtin_offsetof(struct M68KState, JIT_RETURN_TOP));
+        *ptr++ = ldr_offset(top, tmp, __builtin_offsetof(struct M68KState, JIT_RETURN_STACK[0].M68K));
+        *ptr++ = cmp_reg(tmp, REG_PC, LSL, 0);
+        exit_2 = ptr;
+        *ptr++ = b_cc(A64_CC_NE, 0);
+
+        /* Predicted correctly. Leave through the dispatcher anyway if interrupt is pending or cache is off */
+        *ptr++ = ldr_offset(ctx, tmp, __builtin_offsetof(struct M68KState, INT32));
+        exit_3 = ptr;
+        *ptr++ = cbnz(tmp, 0);
+        *ptr++ = mov_simd_to_reg(tmp, 31, TS_S, 0);
+        exit_4 = ptr;
+        *ptr++ = tbz(tmp, CACRB_IE, 0);
+        *ptr++ = ldr64_offset(top, tmp, __builtin_offsetof(struct M68KState, JIT_RETURN_STACK[0].ARM));
+        *ptr++ = br(tmp);
+
+        *exit_1 = cbz(tmp, ptr - exit_1);
+        *exit_2 = b_cc(A64_CC_NE, ptr - exit_2);
+        *exit_3 = cbnz(tmp, ptr - exit_3);
+        *exit_4 = tbz(tmp, CACRB_IE, ptr - exit_4);
+
+        RA_FreeARMRegister(&ptr, tmp);
+        RA_FreeARMRegister(&ptr, top);
+        RA_FreeARMRegister(&ptr, ctx);
+    }
+#endif
+
+    *ptr++ = bx_lr();
+
+    return ptr;
+}
+
 uint32_t * EMIT_LocalExit(uint32_t *ptr, uint32_t insn_fixup)
+{
+    return EMIT_LinkedExit(ptr, insn_fixup, NULL);
+}
+
+uint32_t * EMIT_LinkedExit(uint32_t *ptr, uint32_t insn_fixup, uint16_t *m68k_target)
 {
     RA_StoreDirtyFPURegs(&ptr);
     RA_StoreDirtyM68kRegs(&ptr);
@@ -284,16 +650,121 @@ uint32_t * EMIT_LocalExit(uint32_t *ptr, uint32_t insn_fixup)
     (void)insn_fixup;
 #endif
 
-    *ptr++ = bx_lr();
+    ptr = EMIT_ChainExit(ptr, m68k_target);
+
+    return ptr;
+}
+
+/*
+    Emit prefetch hints for streams of a loop running from loop_start up to the backward branch at
+    loop_end. Address registers walked with (An)+ or -(An) in one direction only are prefetched the
+    distance set in JITCTRL2 ahead, for load if the loop reads through them and for store if it only
+    writes. Prefetch does not fault, addresses outside of RAM need no check.
+*/
+uint32_t *EMIT_LoopPrefetch(uint32_t *ptr, uint16_t *loop_start, uint16_t *loop_end)
+{
+#if EMU68_LOOP_PREFETCH
+    uint32_t distance = 64 * ((__m68k_state->JIT_CONTROL2 >> JC2B_PREFETCH) & JC2_PREFETCH_MASK);
+    uint8_t inc = 0, dec = 0, read = 0;
+    int count = 0;
+
+    if (distance == 0 || loop_start >= loop_end)
+        return ptr;
+
+    for (uint16_t *insn = loop_start; insn < loop_end; count++)
+    {
+        uint16_t opcode = M68K_FetchWord((uintptr_t)insn);
+        uint8_t line = opcode >> 12;
+        int length = M68K_GetINSNLength(insn);
+
+        /* Long loops are not streaming kernels, do not scan them */
+        if (length <= 0 || count >= 32)
+            return ptr;
+
+        insn += length;
+
+        /* No effective address in low bits of Bcc, MOVEQ, line A and shifts of registers */
+        if (line == 6 || line == 7 || line == 0xa || (line == 0xe && (opcode & 0xc0) != 0xc0))
+            continue;
+
+        switch ((opcode >> 3) & 7)
+        {
+            case 3:
+                inc |= 1 << (opcode & 7);
+                read |= 1 << (opcode & 7);
+                break;
+            case 4:
+                dec |= 1 << (opcode & 7);
+                read |= 1 << (opcode & 7);
+                break;
+        }
+
+        /* Destination of MOVE */
+        if (line >= 1 && line <= 3)
+        {
+            switch ((opcode >> 6) & 7)
+            {
+                case 3:
+                    inc |= 1 << ((opcode >> 9) & 7);
+                    break;
+                case 4:
+                    dec |= 1 << ((opcode >> 9) & 7);
+                    break;
+            }
+        }
+    }
+
+    for (int i=0; i < 8; i++)
+    {
+        /* Register walked in both directions has no constant stride */
+        if (((inc ^ dec) & (1 << i)) == 0)
+            continue;
+
+        uint8_t prfop = (read & (1 << i)) ? A64_PRF_PLDL1STRM : A64_PRF_PSTL1STRM;
+        uint8_t reg = RA_MapM68kRegister(&ptr, 8 + i);
+
+        if (inc & (1 << i))
+        {
+            *ptr++ = prfm_offset(reg, prfop, distance);
+        }
+        else
+        {
+            uint8_t tmp = RA_AllocARMRegister(&ptr);
+            *ptr++ = sub_immed(tmp, reg, distance);
+            *ptr++ = prfm_offset(tmp, prfop, 0);
+            RA_FreeARMRegister(&ptr, tmp);
+        }
+    }
+#else
+    (void)loop_start;
+    (void)loop_end;
+#endif
 
     return ptr;
 }
 
 uint16_t * m68k_entry_point;
 
-static inline uintptr_t M68K_Translate(uint16_t *m68kcodeptr)
+/* Translation parameters of the unit being translated, tier dependent */
+int32_t var_EMU68_BRANCH_INLINE_DISTANCE;
+int var_EMU68_CCR_SCAN_DEPTH;
+
+/* Set while hot unit is being retranslated by M68K_PromoteUnit */
+static int promote_unit;
+/* Exit counts of the first tier unit being promoted */
+static uint16_t *profile_source[MAX_UNIT_LINKS];
+static uint32_t profile_exits[MAX_UNIT_LINKS];
+static uint32_t profile_count;
+static uint64_t profile_entries;
+
+/*
+    Translate m68k code starting at m68kcodeptr into temporary buffer. The tier is 0 if tiered
+    translation is not used, 1 for fast first tier translation and 2 for retranslation of hot code.
+*/
+static inline uintptr_t M68K_Translate(uint16_t *m68kcodeptr, int tier)
 {
     m68k_entry_point = m68kcodeptr;
+    translation_tier = tier;
     uint16_t *orig_m68kcodeptr = m68kcodeptr;
     uintptr_t hash = (uintptr_t)m68kcodeptr;
     int var_EMU68_MAX_LOOP_COUNT = (__m68k_state->JIT_CONTROL >> JCCB_LOOP_COUNT) & JCCB_LOOP_COUNT_MASK;
@@ -302,6 +773,27 @@ static inline uintptr_t M68K_Translate(uint16_t *m68kcodeptr)
     uint32_t var_EMU68_M68K_INSN_DEPTH = (__m68k_state->JIT_CONTROL >> JCCB_INSN_DEPTH) & JCCB_INSN_DEPTH_MASK;
     if (var_EMU68_M68K_INSN_DEPTH == 0)
         var_EMU68_M68K_INSN_DEPTH = JCCB_INSN_DEPTH_MASK + 1;
+    var_EMU68_BRANCH_INLINE_DISTANCE = (__m68k_state->JIT_CONTROL >> JCCB_INLINE_RANGE) & JCCB_INLINE_RANGE_MASK;
+    var_EMU68_CCR_SCAN_DEPTH = (__m68k_state->JIT_CONTROL2 >> JC2B_CCR_SCAN_DEPTH) & JC2_CCR_SCAN_MASK;
+
+    /* First tier trades quality of generated code for translation speed */
+    if (tier == 1)
+    {
+        if (var_EMU68_M68K_INSN_DEPTH > EMU68_TIER1_INSN_DEPTH)
+            var_EMU68_M68K_INSN_DEPTH = EMU68_TIER1_INSN_DEPTH;
+        if (var_EMU68_BRANCH_INLINE_DISTANCE > EMU68_TIER1_INLINE_RANGE)
+            var_EMU68_BRANCH_INLINE_DISTANCE = EMU68_TIER1_INLINE_RANGE;
+        if (var_EMU68_CCR_SCAN_DEPTH > EMU68_TIER1_CCR_SCAN_DEPTH)
+            var_EMU68_CCR_SCAN_DEPTH = EMU68_TIER1_CCR_SCAN_DEPTH;
+    }
+
+    /* Decode code following the entry once, emitters and M68K_GetSRMask use the decoded window */
+    M68K_DecodeUnit(m68kcodeptr, var_EMU68_M68K_INSN_DEPTH + var_EMU68_CCR_SCAN_DEPTH);
+
+    int use_ir = (__m68k_state->JIT_CONTROL2 & JC2F_IR_PASSES) != 0;
+    int use_peephole = (__m68k_state->JIT_CONTROL2 & JC2F_PEEPHOLE) != 0;
+    if (use_ir)
+        M68K_BuildIR();
 
     uint16_t *last_rev_jump = (uint16_t *)0xffffffff;
 
@@ -330,8 +822,8 @@ static inline uintptr_t M68K_Translate(uint16_t *m68kcodeptr)
     M68K_ResetReturnStack();
 
     if (debug) {
-        uint32_t hash_calc = (hash >> EMU68_HASHSHIFT) & EMU68_HASHMASK;
-        kprintf("[ICache] Creating new translation unit with hash %04x (m68k code @ %p)\n", hash_calc, (void*)m68kcodeptr);
+        uint32_t hash_calc = (hash << 2) & EMU68_UNIT_TABLE_LINE_MASK;
+        kprintf("[ICache] Creating new translation unit at table line %04x (m68k code @ %p)\n", hash_calc >> 6, (void*)m68kcodeptr);
         if (debug > 1)
             M68K_PrintContext(__m68k_state);
     }
@@ -343,6 +835,14 @@ static inline uintptr_t M68K_Translate(uint16_t *m68kcodeptr)
     conditionals_count = 0;
 
     insn_count = 0;
+    link_count = 0;
+#if EMU68_SIDE_ENTRIES
+    entry_count = 0;
+#endif
+#if EMU68_LAZY_PC
+    pc_map_count = 0;
+#endif
+    return_slot_adr = NULL;
     uint32_t *arm_code = temporary_arm_code;
     uint32_t *end = arm_code;
 
@@ -361,6 +861,36 @@ static inline uintptr_t M68K_Translate(uint16_t *m68kcodeptr)
         RA_FreeARMRegister(&end, reg);
     }
 
+#if EMU68_TIERED_JIT
+    /*
+        First tier unit counts its entries in mt_UseCount. Once the count reaches the threshold,
+        the unit returns to the dispatcher and leaves its address in JIT_TIER_UNIT, asking for
+        retranslation. The request repeats on every entry until it is served. Zero threshold
+        disables promotion.
+    */
+    if (tier == 1)
+    {
+        int32_t diff = __builtin_offsetof(struct M68KTranslationUnit, mt_ARMCode) -
+                       __builtin_offsetof(struct M68KTranslationUnit, mt_UseCount);
+
+        diff += 4 * (end - arm_code);
+        *end++ = adr(0, -diff);
+        *end++ = bic64_immed(0, 0, 1, 64 - 36, 1);  // Executable alias -> writable address
+        *end++ = ldr64_offset(0, 1, 0);
+        *end++ = add64_immed(1, 1, 1);
+        *end++ = str64_offset(0, 1, 0);
+        *end++ = mrs(2, 3, 3, 13, 0, 3);
+        *end++ = ldr_offset(2, 3, __builtin_offsetof(struct M68KState, JIT_TIER_THRESH));
+        *end++ = cbz(3, 7);
+        *end++ = cmp64_reg(1, 3, LSL, 0);
+        *end++ = b_cc(A64_CC_CC, 5);
+        *end++ = str64_offset(2, 0, __builtin_offsetof(struct M68KState, JIT_TIER_UNIT));
+        *end++ = movn_immed_u16(1, 0, 0);
+        *end++ = msr(1, 3, 0, 13, 0, 4);            // Invalidate LastPC
+        *end++ = bx_lr();
+    }
+#endif
+
     prologue_size = end - tmpptr;
 
     int break_loop = FALSE;
@@ -401,11 +931,104 @@ static inline uintptr_t M68K_Translate(uint16_t *m68kcodeptr)
             }
         }
 
+        uint16_t opcode = M68K_FetchWord((uint32_t)(uintptr_t)m68kcodeptr);
+
+        /* Flags left in host NZCV can be consumed by a Bcc only */
+        if ((opcode & 0xf000) != 0x6000 || ((opcode >> 8) & 15) < M_CC_HI)
+            RA_ResolveLazyCC(&end);
+
+        /*
+            If a compare or test is followed by a Bcc, the flags tested by the branch can stay in
+            host NZCV. Only the flags needed past the branch are materialized.
+        */
+        if ((__m68k_state->JIT_CONTROL2 & JC2F_LAZY_FLAGS) &&
+            ((opcode & 0xf000) == 0x0000 || (opcode & 0xf000) == 0x4000 || (opcode & 0xf000) == 0xb000))
+        {
+            uint16_t *next = m68kcodeptr + M68K_GetINSNLength(m68kcodeptr);
+            uint16_t next_opcode = M68K_FetchWord((uint32_t)(uintptr_t)next);
+
+            if ((next_opcode & 0xf000) == 0x6000 && ((next_opcode >> 8) & 15) >= M_CC_HI)
+                RA_AllowLazyCC((next_opcode >> 8) & 15, M68K_GetSRMaskAfterBranch(next, SR_CCR));
+        }
+
         local_state[insn_count].mls_ARMOffset = end - arm_code;
         local_state[insn_count].mls_M68kPtr = m68kcodeptr;
         local_state[insn_count].mls_PCRel = _pc_rel;
 
-        end = EmitINSN(end, &m68kcodeptr, &insn_consumed);
+#if EMU68_LAZY_PC
+        /* Once an instruction is out of reach, the rest of the unit is marked unknown */
+        if (pc_map_count == 0 || pc_map[pc_map_count - 1].pm_M68kOffset != PCMAP_UNKNOWN)
+        {
+            intptr_t m68k_offset = (uintptr_t)m68kcodeptr - (uintptr_t)orig_m68kcodeptr;
+
+            pc_map[pc_map_count].pm_ARMOffset = end - arm_code;
+            pc_map[pc_map_count].pm_M68kOffset = (m68k_offset > 32767 || m68k_offset <= PCMAP_UNKNOWN) ? PCMAP_UNKNOWN : m68k_offset;
+            pc_map_count++;
+        }
+#endif
+
+#if EMU68_SIDE_ENTRIES
+        /* Boundary with nothing cached in host registers can be entered from outside of the unit */
+        if (insn_count != 0 && entry_count < EMU68_UNIT_MAX_ENTRIES && (end - arm_code) <= 0xffff &&
+            RA_GetTempAllocMask() == 0 && !RA_IsLazyCC() && val_FPIAR == 0xffffffff)
+        {
+            uint32_t i;
+
+            for (i=0; i < entry_count; i++)
+            {
+                if (entry_m68k[i] == m68kcodeptr)
+                    break;
+            }
+
+            if (i == entry_count)
+            {
+                entry_m68k[entry_count] = m68kcodeptr;
+                entry_state[entry_count].se_ARMOffset = end - arm_code;
+                entry_state[entry_count].se_InsnCount = insn_count;
+                entry_state[entry_count].se_PCRel = _pc_rel;
+                entry_count++;
+            }
+        }
+#endif
+
+        /* Code of the instruction starts here, code emitted above belongs to the previous one */
+        uint32_t *insn_code = end;
+        uint8_t insn_ctx = RA_TryCTX(&end);
+
+        exit_target = NULL;
+        exit_indirect = 0;
+        exit_return = 0;
+        exit_source = m68kcodeptr;
+        int ir_skip = use_ir ? M68K_IRSkip(m68kcodeptr, var_EMU68_M68K_INSN_DEPTH - insn_count) : 0;
+        uint32_t *ir_code;
+
+        /* Instruction dropped by IR passes, only the PC advances */
+        if (ir_skip)
+        {
+#if EMU68_SIDE_ENTRIES
+            /* Dropping is valid only if the code was entered at its beginning */
+            entry_count = 0;
+#endif
+            end = EMIT_AdvancePC(end, 2 * ir_skip);
+            m68kcodeptr += ir_skip;
+            insn_consumed = 1;
+        }
+        /* Instruction rewritten by IR passes into load of a constant */
+        else if (use_ir && (ir_code = M68K_IRLower(end, &m68kcodeptr)) != NULL)
+        {
+#if EMU68_SIDE_ENTRIES
+            /* The constant is valid only if the code was entered at its beginning */
+            entry_count = 0;
+#endif
+            end = ir_code;
+            insn_consumed = 1;
+        }
+        else
+            end = EmitINSN(end, &m68kcodeptr, &insn_consumed);
+        RA_AllowLazyCC(0xff, 0);
+
+        if (use_ir)
+            M68K_IRAdvance(in_code, m68kcodeptr);
 
         if (m68kcodeptr < m68k_low)
             m68k_low = m68kcodeptr;
@@ -433,9 +1056,11 @@ static inline uintptr_t M68K_Translate(uint16_t *m68kcodeptr)
             uint32_t *tmpptr;
             uint32_t *branch_mod[10];
             uint32_t branch_cnt;
+            uint16_t *branch_target;
             int local_branch_done = 0;
             end--;
-            end--;  /* Remove branch target (unused!) */
+            /* Static m68k target of the exit, or 0 if it is computed at runtime */
+            branch_target = (uint16_t *)(uintptr_t)*--end;
             branch_cnt = *--end;
 
             for (unsigned i=0; i < branch_cnt; i++)
@@ -451,7 +1076,15 @@ static inline uintptr_t M68K_Translate(uint16_t *m68kcodeptr)
 
             if (!local_branch_done)
             {
-                end = EMIT_LocalExit(end, 0);
+#if EMU68_LAZY_PC
+                /* PC register was set on the exit path already, main path keeps its pending offset */
+                int32_t pc_rel = _pc_rel;
+                _pc_rel = 0;
+                end = EMIT_LinkedExit(end, 0, branch_target);
+                _pc_rel = pc_rel;
+#else
+                end = EMIT_LinkedExit(end, 0, branch_target);
+#endif
             }
             int distance = end - tmpptr;
 
@@ -462,6 +1095,9 @@ static inline uintptr_t M68K_Translate(uint16_t *m68kcodeptr)
             epilogue_size += distance;
         }
 
+        if (use_peephole && end > insn_code)
+            end = A64_Peephole(insn_code, end, RA_GetTempAllocMask(), insn_ctx);
+
         if (disasm)
             disasm_print(in_code, insn_consumed, out_code, 4*(end - out_code), temporary_arm_code);
 
@@ -469,6 +1105,11 @@ static inline uintptr_t M68K_Translate(uint16_t *m68kcodeptr)
         {
             if (debug)
                 kprintf("[ICache]   Going backwards to location %08x\n", m68kcodeptr);
+
+            /* First tier does not unroll loops */
+            if (tier == 1)
+                break;
+
             if (last_rev_jump == m68kcodeptr) {
                 if (--max_rev_jumps == 0) {
                     if (debug)
@@ -491,8 +1132,20 @@ static inline uintptr_t M68K_Translate(uint16_t *m68kcodeptr)
             break;
         }
     }
+    /*
+        Unless the unit ended with a computed jump, the m68k PC at the end of the unit is
+        known now and the exit can be chained with the next unit.
+    */
+    uint16_t *unit_exit = NULL;
+    if (break_loop)
+        unit_exit = exit_target;
+    else if (!inner_loop)
+        unit_exit = m68kcodeptr;
+
     uint32_t *out_code = end;
     tmpptr = end;
+    exit_source = NULL;
+    RA_ResolveLazyCC(&end);
     RA_FlushFPURegs(&end);
     RA_FlushM68kRegs(&end);
     end = EMIT_FlushPC(end);
@@ -540,7 +1193,29 @@ static inline uintptr_t M68K_Translate(uint16_t *m68kcodeptr)
         *end++ = cbz(tmp2, arm_code - tmpptr);
 #endif
     }
-    *end++ = bx_lr();
+    if (break_loop && exit_indirect)
+        end = EMIT_BranchCacheExit(end);
+    else if (break_loop && exit_return)
+        end = EMIT_ReturnStackExit(end);
+    else
+        end = EMIT_ChainExit(end, unit_exit);
+
+    /* Slot used by RTS returning to the instruction following BSR/JSR which ended this unit */
+    if (return_slot_adr)
+    {
+        *return_slot_adr = adr(return_slot_reg, 4 * (end - return_slot_adr));
+
+        if (link_count < MAX_UNIT_LINKS && (__m68k_state->JIT_CONTROL2 & JC2F_CHAIN_UNITS))
+        {
+            link_offset[link_count] = end - temporary_arm_code;
+            link_target[link_count] = return_slot_pc;
+            link_source[link_count] = NULL;
+            link_counter[link_count] = 0;
+            link_count++;
+        }
+
+        *end++ = bx_lr();
+    }
     
     uint32_t *_tmpptr = end;
     RA_FreeARMRegister(&end, tmp2);
@@ -577,6 +1252,8 @@ static inline uintptr_t M68K_Translate(uint16_t *m68kcodeptr)
         kprintf("[ICache]   Mean ARM instructions per m68k instruction: %d.%02d\n", mean_n, mean_f);
     }
 
+    M68K_ReleaseDecodedUnit();
+
     return (uintptr_t)end - (uintptr_t)arm_code;
 }
 
@@ -587,7 +1264,9 @@ static inline uintptr_t M68K_Translate(uint16_t *m68kcodeptr)
 */
 void *M68K_TranslateNoCache(uint16_t *m68kcodeptr)
 {
-    uintptr_t line_length = M68K_Translate(m68kcodeptr);
+    temporary_arm_code = scratch_arm_code;
+
+    uintptr_t line_length = M68K_Translate(m68kcodeptr, 0);
     void *entry_point = (void*)temporary_arm_code;
 
     entry_point = (void *)((uintptr_t)entry_point | 0x0000001000000000ULL);
@@ -598,99 +1277,1331 @@ void *M68K_TranslateNoCache(uint16_t *m68kcodeptr)
     return entry_point;
 } 
 
-/*
-    Verify if the translated code has changed since the unit was created. In order
-    to do this MD5 sum of the block is compared with the previousy calculated one.
-
-    If th sums are not same, the block is removed form LRU cache and hashtable and memory
-    is released.
+#if EMU68_PIN_UNITS || EMU68_WARM_RESET || EMU68_JIT_SNAPSHOT
+/* Ranges mapped read-only from ROM at boot */
+static inline int M68K_IsROM(uint32_t low, uint32_t high)
+{
+    return (low >= 0x00f00000 && high <= 0x01000000) || (low >= 0x00e00000 && high <= 0x00e80000) ||
+           (low >= 0x00a80000 && high <= 0x00b80000);
+}
+#endif
 
-    The function returns poitner to verified unit or NULL if the unit changed
+#if EMU68_PIN_UNITS
+/*
+    Units kept in the cache while other ones can be evicted, selected by the JC2_PIN field of JITCTRL2:
+    units translated from ROM, second tier units, and units translated from RAM outside of chip
+    memory, so that code in chip RAM goes first. Soft flushed and side entry units are never pinned.
 */
-struct M68KTranslationUnit *M68K_VerifyUnit(struct M68KTranslationUnit *unit)
+static int M68K_IsPinned(struct M68KTranslationUnit *unit)
 {
-    if (unit)
-    {
-        uint32_t crc = CalcCRC32(unit->mt_M68kLow, unit->mt_M68kHigh);
+    uint32_t pin = (__m68k_state->JIT_CONTROL2 >> JC2B_PIN) & JC2_PIN_MASK;
+    uint32_t low = (uint32_t)(uintptr_t)unit->mt_M68kLow;
+    uint32_t high = (uint32_t)(uintptr_t)unit->mt_M68kHigh;
+
+    if (pin == 0 || ((uintptr_t)unit->mt_ARMEntryPoint >> 56) == 0xaa)
+        return 0;
+#if EMU68_SIDE_ENTRIES
+    if (unit->mt_LinkCount != 0 && unit->mt_Links[0].ml_M68kTarget == SIDE_ENTRY_LINK)
+        return 0;
+#endif
 
-        if (crc != unit->mt_CRC32)
-        {
-            REMOVE(&unit->mt_LRUNode);
-            REMOVE(&unit->mt_HashNode);
-            tlsf_free(jit_tlsf, unit);
+    if ((pin & JC2_PIN_ROM) && M68K_IsROM(low, high))
+        return 1;
+    if ((pin & JC2_PIN_HOT) && unit->mt_Tier == 2)
+        return 1;
+    if ((pin & JC2_PIN_RAM) && low >= 0x00200000 && !M68K_IsROM(low, high))
+        return 1;
 
-            __m68k_state->JIT_UNIT_COUNT--;
-            __m68k_state->JIT_CACHE_FREE = tlsf_get_free_size(jit_tlsf);
+    return 0;
+}
+#endif
 
-            unit = NULL;
-        }
+static inline int M68K_IsReferenced(struct M68KTranslationUnit *unit)
+{
+    struct M68KUnitLink *link;
+
+    if (unit->mt_Referenced)
+        return 1;
+
+    /* Chained units are entered without passing the dispatcher. Keep them while their callers are used */
+    ForeachNode(&unit->mt_Incoming, link)
+    {
+        if (link->ml_Unit->mt_Referenced)
+            return 1;
     }
 
-    return unit;
+    return 0;
 }
 
 /*
-    Get M68K code unit from the instruction cache. Return NULL if code was not found and needs to be
-    translated first.
-
-    If the code was found, update its position in the LRU cache.
+    JIT pool grows by 2MB pages of the reserve mapped behind it at boot (see jit_max= on the command
+    line) instead of evicting units once it is full. Returns address of the new page, 0 once the
+    reserve is used up.
 */
-struct M68KTranslationUnit *M68K_GetTranslationUnit(uint16_t *m68kcodeptr)
+#define JIT_GROW_SIZE   (1 << 21)
+
+static uintptr_t jit_reserve_used;
+
+static uintptr_t M68K_GrowCache()
 {
-    struct M68KTranslationUnit *unit = NULL; //, *n;
-    uintptr_t hash = (uintptr_t)m68kcodeptr;
-    uint16_t *orig_m68kcodeptr = m68kcodeptr;
-    
-    int debug = 0;
+    uintptr_t page;
 
-    if ((uint32_t)(uintptr_t)m68kcodeptr >= debug_range_min && (uint32_t)(uintptr_t)m68kcodeptr <= debug_range_max) {
-        debug = globalDebug();
-    }
+    if (jit_reserve_used + JIT_GROW_SIZE > jit_reserve_size)
+        return 0;
 
-    /* Get 16-bit has from the pointer to m68k code */
-    hash = (hash >> EMU68_HASHSHIFT) & EMU68_HASHMASK;
+    page = jit_reserve + jit_reserve_used;
+    jit_reserve_used += JIT_GROW_SIZE;
 
-    if (debug > 2)
-        kprintf("[ICache] GetTranslationUnit(%08x)\n[ICache] Hash: 0x%04x\n", (void*)m68kcodeptr, (int)hash);
+#if !EMU68_JIT_ARENA
+    tlsf_add_memory(jit_tlsf, (void *)page, JIT_GROW_SIZE);
+#endif
+    __m68k_state->JIT_CACHE_TOTAL += JIT_GROW_SIZE;
 
-    if (unit == NULL)
-    {
-        uintptr_t line_length = M68K_Translate(m68kcodeptr);
-        uintptr_t arm_insn_count = line_length/4 - 1;
+    kprintf("[ICache] JIT pool grown to %d kB\n", __m68k_state->JIT_CACHE_TOTAL >> 10);
 
-        uintptr_t unit_length = (line_length + 63 + sizeof(struct M68KTranslationUnit)) & ~63;
+    return page;
+}
 
-        do {
-            unit = tlsf_malloc_aligned(jit_tlsf, unit_length, 64);
+#if EMU68_JIT_ARENA
+/*
+    Ring arena for JIT units. Units are emitted directly at the head of the ring and committed with
+    their final size. Space is reclaimed at the tail only, units in the way are evicted in the order
+    they were created unless pinned or used recently. Units released earlier leave holes marked in mt_AllocSize, which are skipped
+    once the tail reaches them. Free space at the end of the arena too small for a unit is filled
+    with a released block and the head wraps around.
+
+    Pages of the JIT reserve form second segment of the ring, following the first one. It is created
+    and extended when the head reaches the end of the ring, before wrapping around.
+*/
+static uintptr_t arena_base;
+static uintptr_t arena_end;
+static uintptr_t arena_grow_base;
+static uintptr_t arena_grow_end;
+static uintptr_t arena_head;
+static uintptr_t arena_tail;
+static uintptr_t arena_used;
+static uintptr_t arena_moved;       /* Bytes of units moved to the head since the tail wrapped */
+
+/* Largest possible unit: header, code from temporary buffer, all links and page records */
+#define ARENA_UNIT_MAX  ((sizeof(struct M68KTranslationUnit) + (JCCB_INSN_DEPTH_MASK + 1) * 16 * 64 + \
+                          MAX_UNIT_LINKS * sizeof(struct M68KUnitLink) + \
+                          EMU68_UNIT_MAX_PAGES * sizeof(struct M68KUnitPage) + \
+                          (JCCB_INSN_DEPTH_MASK + 1) * sizeof(struct M68KPCMap) + 63) & ~63)
+
+static inline uintptr_t Arena_Size()
+{
+    return (arena_end - arena_base) + (arena_grow_end - arena_grow_base);
+}
 
-            __m68k_state->JIT_CACHE_FREE = tlsf_get_free_size(jit_tlsf);
+static inline uintptr_t Arena_SegmentEnd(uintptr_t p)
+{
+    return (p >= arena_base && p <= arena_end) ? arena_end : arena_grow_end;
+}
 
-            if (unit == NULL)
+static inline uintptr_t Arena_NextSegment(uintptr_t end)
+{
+    return (end == arena_end && arena_grow_end != arena_grow_base) ? arena_grow_base : arena_base;
+}
+
+static int Arena_Grow()
+{
+    uintptr_t page = M68K_GrowCache();
+
+    if (page == 0)
+        return 0;
+
+    /* Pages of the reserve are contiguous */
+    if (arena_grow_end == arena_grow_base)
+        arena_grow_base = page;
+    arena_grow_end = page + JIT_GROW_SIZE;
+
+    return 1;
+}
+
+static void Arena_AdvanceTail(uintptr_t size)
+{
+    arena_tail += size;
+    arena_used -= size;
+
+    if (arena_tail == Arena_SegmentEnd(arena_tail))
+    {
+        arena_tail = Arena_NextSegment(arena_tail);
+        if (arena_tail == arena_base)
+            arena_moved = 0;
+    }
+}
+
+static void Arena_Reclaim()
+{
+    while (arena_used != 0)
+    {
+        struct M68KTranslationUnit *block = (struct M68KTranslationUnit *)arena_tail;
+
+        if ((block->mt_AllocSize & 1) == 0)
+            break;
+
+        Arena_AdvanceTail(block->mt_AllocSize & ~63);
+    }
+}
+
+/*
+    Remove unit occupying the tail of the arena. Pinned or referenced unit is moved to the head
+    instead, which is never further than the tail. Up to a quarter of the arena is moved during one
+    lap of the tail, units beyond that are evicted as any other unit.
+*/
+static void Arena_EvictTail()
+{
+    struct M68KTranslationUnit *unit = (struct M68KTranslationUnit *)arena_tail;
+
+    if (unit->mt_AllocSize & 1)
+    {
+        Arena_Reclaim();
+        return;
+    }
+
+    uintptr_t size = unit->mt_AllocSize;
+    int keep = 0;
+
+#if EMU68_PIN_UNITS
+    keep = M68K_IsPinned(unit);
+#endif
+
+    /*
+        Second chance as in M68K_ClockVictim: unit used since the tail passed it last time loses its
+        reference bit and moves to the head. Soft flushed and side entry units are not moved, links
+        into the copy would bypass the checksum verification or the branch into the owner would be lost.
+    */
+    if (!keep && M68K_IsReferenced(unit) && ((uintptr_t)unit->mt_ARMEntryPoint >> 56) != 0xaa)
+    {
+        keep = 1;
+#if EMU68_SIDE_ENTRIES
+        if (unit->mt_LinkCount != 0 && unit->mt_Links[0].ml_M68kTarget == SIDE_ENTRY_LINK)
+            keep = 0;
+#endif
+        if (keep && arena_moved + size <= Arena_Size() / 4)
+            unit->mt_Referenced = 0;
+    }
+
+    if (keep && arena_moved + size <= Arena_Size() / 4)
+    {
+        struct M68KTranslationUnit *copy = (struct M68KTranslationUnit *)arena_head;
+
+        arena_moved += size;
+        Arena_AdvanceTail(size);
+        M68K_MoveUnit(unit, copy);
+        arena_head += size;
+        arena_used += size;
+        Arena_Reclaim();
+
+        return;
+    }
+
+    M68K_UnlinkUnit(unit, 1);
+    REMOVE(&unit->mt_LRUNode);
+    M68K_RemoveUnit(unit);
+    M68K_FreeUnit(unit);
+    __m68k_state->JIT_UNIT_COUNT--;
+
+    asm volatile("msr tpidr_el1, %0"::"r"(0xffffffff));
+}
+
+/* Make ARENA_UNIT_MAX bytes free at the head of the arena, return the space */
+static struct M68KTranslationUnit *Arena_Reserve()
+{
+    while (1)
+    {
+        if (arena_used == 0)
+            arena_head = arena_tail = arena_base;
+
+        uintptr_t end = Arena_SegmentEnd(arena_head);
+
+        /* Tail is in front of the head in the same segment, only the space in between is free */
+        if ((arena_tail > arena_head || (arena_tail == arena_head && arena_used != 0)) && arena_tail <= end)
+        {
+            if (arena_tail - arena_head >= ARENA_UNIT_MAX)
+                return (struct M68KTranslationUnit *)arena_head;
+
+            Arena_EvictTail();
+            continue;
+        }
+
+        if (end - arena_head >= ARENA_UNIT_MAX)
+            return (struct M68KTranslationUnit *)arena_head;
+
+        /* End of the ring reached. Grow it with next page of the reserve if there is one */
+        if (Arena_NextSegment(end) == arena_base && Arena_Grow())
+            continue;
+
+        /* Not enough place at the end. Fill it with released block and go to the next segment */
+        if (end != arena_head)
+        {
+            ((struct M68KTranslationUnit *)arena_head)->mt_AllocSize = (end - arena_head) | 1;
+            arena_used += end - arena_head;
+        }
+        arena_head = Arena_NextSegment(end);
+    }
+}
+
+static void Arena_Commit(struct M68KTranslationUnit *unit, uintptr_t size)
+{
+    unit->mt_AllocSize = size;
+    arena_head += size;
+    arena_used += size;
+}
+#endif
+
+uint32_t M68K_GetCacheFree()
+{
+#if EMU68_JIT_ARENA
+    return (Arena_Size() - arena_used) + tlsf_get_free_size(jit_tlsf);
+#else
+    return tlsf_get_free_size(jit_tlsf);
+#endif
+}
+
+#if EMU68_BACKGROUND_VERIFY
+/*
+    Background verification of soft flushed units. After a soft flush of the whole cache the units
+    are put into the queue and a worker on a spare CPU core is woken up. The worker claims queued
+    slots in order, computes checksums of their m68k code and clears the 0xaa tag of unchanged units,
+    so that the dispatcher enters them directly again. Everything else - relinking unchanged units
+    and releasing changed ones - is left to the emulation core, which collects finished slots when
+    it translates code next time.
+
+    Emulation core never releases a slot while the worker holds it. Every unit is taken out of the
+    queue before it is tagged again or released, therefore worker can neither clear a newer tag nor
+    touch a unit which is gone.
+*/
+enum {
+    VS_FREE,
+    VS_QUEUED,
+    VS_BUSY,
+    VS_VALID,
+    VS_CHANGED,
+};
+
+struct VerifySlot {
+    struct M68KTranslationUnit * vs_Unit;
+    uint32_t    vs_State;
+};
+
+static struct VerifySlot verify_queue[EMU68_VERIFY_QUEUE_SIZE];
+static uint32_t verify_top;         /* Slots filled since last soft flush */
+static uint32_t verify_collect;     /* First slot not collected by the emulation core yet */
+static uint32_t verify_round;       /* Incremented when the queue starts over */
+static uint8_t verify_worker;       /* Set once the worker runs */
+
+/* Take the unit out of the queue, waiting if the worker checks it right now. Returns last state of the slot */
+static uint32_t Verify_Cancel(struct M68KTranslationUnit *unit)
+{
+    struct VerifySlot *slot;
+    uint32_t state;
+
+    if (unit->mt_VerifySlot == 0)
+        return VS_FREE;
+
+    slot = &verify_queue[unit->mt_VerifySlot - 1];
+
+    do {
+        while ((state = __atomic_load_n(&slot->vs_State, __ATOMIC_ACQUIRE)) == VS_BUSY)
+            asm volatile("yield");
+    } while (!__atomic_compare_exchange_n(&slot->vs_State, &state, VS_FREE, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+    unit->mt_VerifySlot = 0;
+
+    return state;
+}
+
+/* Drop everything queued so far and start over at the first slot */
+static void Verify_Restart()
+{
+    for (uint32_t i = verify_collect; i < verify_top; i++)
+    {
+        if (__atomic_load_n(&verify_queue[i].vs_State, __ATOMIC_ACQUIRE) != VS_FREE)
+            Verify_Cancel(verify_queue[i].vs_Unit);
+    }
+
+    verify_collect = 0;
+    __atomic_store_n(&verify_top, 0, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&verify_round, 1, __ATOMIC_RELEASE);
+}
+
+static void Verify_Queue(struct M68KTranslationUnit *unit)
+{
+    /* Code in lower 16MB is read through the emulated cache, which only the emulation core may use */
+    if (verify_top == EMU68_VERIFY_QUEUE_SIZE || (uintptr_t)unit->mt_M68kLow < 0x01000000)
+        return;
+
+    verify_queue[verify_top].vs_Unit = unit;
+    __atomic_store_n(&verify_queue[verify_top].vs_State, VS_QUEUED, __ATOMIC_RELEASE);
+    unit->mt_VerifySlot = verify_top + 1;
+    __atomic_store_n(&verify_top, verify_top + 1, __ATOMIC_RELEASE);
+}
+
+/* Relink units found unchanged by the worker and release changed ones */
+static void Verify_Collect()
+{
+    while (verify_collect < verify_top)
+    {
+        struct VerifySlot *slot = &verify_queue[verify_collect];
+        uint32_t state = __atomic_load_n(&slot->vs_State, __ATOMIC_ACQUIRE);
+
+        if (state == VS_QUEUED || state == VS_BUSY)
+            break;
+
+        verify_collect++;
+
+        if (state == VS_FREE)
+            continue;
+
+        if (M68K_VerifyUnit(slot->vs_Unit) != NULL)
+        {
+            M68K_ProtectUnitPages(slot->vs_Unit);
+            M68K_LinkUnit(slot->vs_Unit);
+        }
+        else
+            asm volatile("msr tpidr_el1, %0"::"r"(0xffffffff));
+    }
+}
+
+/* Main loop of the worker, never returns */
+void M68K_VerifyWorker()
+{
+    uint32_t round = 0;
+    uint32_t i = 0;
+
+    __atomic_store_n(&verify_worker, 1, __ATOMIC_RELEASE);
+
+    while(1)
+    {
+        uint32_t r = __atomic_load_n(&verify_round, __ATOMIC_ACQUIRE);
+        struct VerifySlot *slot;
+        struct M68KTranslationUnit *unit;
+        uint32_t state = VS_QUEUED;
+        int orphan = 0;
+
+        if (r != round)
+        {
+            round = r;
+            i = 0;
+        }
+
+        if (i >= __atomic_load_n(&verify_top, __ATOMIC_ACQUIRE))
+        {
+            asm volatile("wfe");
+            continue;
+        }
+
+        slot = &verify_queue[i++];
+
+        if (!__atomic_compare_exchange_n(&slot->vs_State, &state, VS_BUSY, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            continue;
+
+        unit = slot->vs_Unit;
+
+#if EMU68_SIDE_ENTRIES
+        orphan = unit->mt_LinkCount != 0 && unit->mt_Links[0].ml_M68kTarget == SIDE_ENTRY_LINK &&
+                 unit->mt_Links[0].ml_Target == NULL;
+#endif
+
+        if (!orphan && CalcCRC32(unit->mt_M68kLow, unit->mt_M68kHigh) == unit->mt_CRC32)
+        {
+            /* Restore the entry address, from now on the unit is entered without fault */
+            *(uint8_t *)&unit->mt_ARMEntryPoint = 0xff;
+            state = VS_VALID;
+        }
+        else
+            state = VS_CHANGED;
+
+        __atomic_store_n(&slot->vs_State, state, __ATOMIC_RELEASE);
+    }
+}
+#endif
+
+/* Release memory of the unit removed from the cache */
+void M68K_FreeUnit(struct M68KTranslationUnit *unit)
+{
+#if EMU68_BACKGROUND_VERIFY
+    Verify_Cancel(unit);
+#endif
+#if EMU68_JIT_ARENA
+    unit->mt_AllocSize |= 1;
+    Arena_Reclaim();
+#else
+    tlsf_free(jit_tlsf, unit);
+#endif
+    __m68k_state->JIT_CACHE_FREE = M68K_GetCacheFree();
+}
+
+/*
+    Verify if the translated code has changed since the unit was created. In order
+    to do this MD5 sum of the block is compared with the previousy calculated one.
+
+    If th sums are not same, the block is removed form LRU cache and hashtable and memory
+    is released.
+
+    The function returns poitner to verified unit or NULL if the unit changed
+*/
+struct M68KTranslationUnit *M68K_VerifyUnit(struct M68KTranslationUnit *unit)
+{
+    if (unit)
+    {
+        uint32_t crc;
+        int orphan = 0;
+
+#if EMU68_BACKGROUND_VERIFY
+        /* Use result of the worker if it has checked the unit already */
+        switch (Verify_Cancel(unit))
+        {
+            case VS_VALID:
+                crc = unit->mt_CRC32;
+                break;
+            case VS_CHANGED:
+                crc = ~unit->mt_CRC32;
+                break;
+            default:
+                crc = CalcCRC32(unit->mt_M68kLow, unit->mt_M68kHigh);
+                break;
+        }
+#else
+        crc = CalcCRC32(unit->mt_M68kLow, unit->mt_M68kHigh);
+#endif
+
+#if EMU68_SIDE_ENTRIES
+        /* Side entry unit lost the unit it was branching into */
+        orphan = unit->mt_LinkCount != 0 && unit->mt_Links[0].ml_M68kTarget == SIDE_ENTRY_LINK &&
+                 unit->mt_Links[0].ml_Target == NULL;
+#endif
+
+        if (crc != unit->mt_CRC32 || orphan)
+        {
+            M68K_UnlinkUnit(unit, 1);
+            REMOVE(&unit->mt_LRUNode);
+            M68K_RemoveUnit(unit);
+            M68K_FreeUnit(unit);
+
+            __m68k_state->JIT_UNIT_COUNT--;
+
+            unit = NULL;
+        }
+        else if (unit->mt_Referenced == 0)
+            unit->mt_Referenced = 1;
+    }
+
+    return unit;
+}
+
+static inline uint32_t UnitTableStart(uint16_t *m68k_address)
+{
+    return (((uint32_t)(uintptr_t)m68k_address << 2) & EMU68_UNIT_TABLE_LINE_MASK) / sizeof(struct M68KUnitSlot);
+}
+
+/* Find unit translated at given m68k address. Same probe sequence as FindUnit in the dispatcher */
+struct M68KTranslationUnit *M68K_FindUnit(uint16_t *m68k_address)
+{
+    uint32_t address = (uint32_t)(uintptr_t)m68k_address;
+
+    for (uint32_t i = UnitTableStart(m68k_address); ; i = (i + 1) % EMU68_UNIT_TABLE_SIZE)
+    {
+        if (UnitTable[i].us_M68kAddress == address)
+            return UnitTable[i].us_Unit;
+        if (UnitTable[i].us_M68kAddress == UNIT_SLOT_EMPTY)
+            return NULL;
+    }
+}
+
+static void UnitTable_Put(struct M68KTranslationUnit *unit)
+{
+    uint32_t i = UnitTableStart(unit->mt_M68kAddress);
+
+    while (UnitTable[i].us_M68kAddress != UNIT_SLOT_EMPTY && UnitTable[i].us_M68kAddress != UNIT_SLOT_DELETED)
+        i = (i + 1) % EMU68_UNIT_TABLE_SIZE;
+
+    if (UnitTable[i].us_M68kAddress == UNIT_SLOT_DELETED)
+        unit_table_deleted--;
+
+    /* Unit first, the dispatcher may look the address up as soon as it is there */
+    UnitTable[i].us_Unit = unit;
+    asm volatile("dmb ishst":::"memory");
+    UnitTable[i].us_M68kAddress = (uint32_t)(uintptr_t)unit->mt_M68kAddress;
+    unit_table_used++;
+}
+
+/* Drop deleted slots by inserting all units from LRU list into an empty table */
+static void UnitTable_Rebuild()
+{
+    struct Node *n;
+
+    for (int i=0; i < EMU68_UNIT_TABLE_SIZE; i++)
+        UnitTable[i].us_M68kAddress = UNIT_SLOT_EMPTY;
+
+    unit_table_used = 0;
+    unit_table_deleted = 0;
+
+    ForeachNode(&LRU, n)
+    {
+        UnitTable_Put((struct M68KTranslationUnit *)((uintptr_t)n - __builtin_offsetof(struct M68KTranslationUnit, mt_LRUNode)));
+    }
+}
+
+/* Number of page entries needed by unit covering m68k code between m68k_low and m68k_high */
+static inline uint32_t UnitPageCount(uint16_t *m68k_low, uint16_t *m68k_high)
+{
+    uint32_t count = ((uint32_t)(uintptr_t)m68k_high >> 12) - ((uint32_t)(uintptr_t)m68k_low >> 12) + 1;
+
+    return count > EMU68_UNIT_MAX_PAGES ? 1 : count;
+}
+
+/* List of units which may overlap given page. Wide units have to be checked in addition */
+struct List *M68K_GetPageUnits(uint32_t page)
+{
+    if (page == UNIT_PAGE_WIDE)
+        return &WideUnits;
+
+    return &PageUnits[page & EMU68_PAGE_HASHMASK];
+}
+
+/* Add unit to the lookup table and page directory. The unit has to be on the LRU list already */
+void M68K_InsertUnit(struct M68KTranslationUnit *unit)
+{
+    uint32_t first_page = (uint32_t)(uintptr_t)unit->mt_M68kLow >> 12;
+    uint32_t last_page = (uint32_t)(uintptr_t)unit->mt_M68kHigh >> 12;
+
+    for (unsigned i=0; i < unit->mt_PageCount; i++)
+    {
+        struct M68KUnitPage *page = &unit->mt_Pages[i];
+
+        page->up_Unit = unit;
+        page->up_Page = (last_page - first_page >= EMU68_UNIT_MAX_PAGES) ? UNIT_PAGE_WIDE : first_page + i;
+        ADDHEAD(M68K_GetPageUnits(page->up_Page), &page->up_Node);
+    }
+
+    /* Probe sequences are ended by empty slots, keep enough of them */
+    if (unit_table_used + unit_table_deleted >= EMU68_UNIT_TABLE_LIMIT)
+        UnitTable_Rebuild();
+    else
+        UnitTable_Put(unit);
+}
+
+#if EMU68_SMC_PROTECT
+/* 4KB pages of m68k address space write protected because they hold translated code */
+static uint32_t smc_pages[1 << 15];
+#endif
+
+/*
+    Write protect the pages of the unit if JC2_SMC_PROTECT is set. Called for new units and for soft
+    flushed units found unchanged, since the first write to a page made it writable again. Units
+    spanning too many pages are not protected.
+*/
+void M68K_ProtectUnitPages(struct M68KTranslationUnit *unit)
+{
+#if EMU68_SMC_PROTECT
+    uint32_t first_page = (uint32_t)(uintptr_t)unit->mt_M68kLow >> 12;
+    uint32_t last_page = (uint32_t)(uintptr_t)unit->mt_M68kHigh >> 12;
+
+    if (!(__m68k_state->JIT_CONTROL2 & JC2F_SMC_PROTECT))
+        return;
+
+    if (last_page - first_page >= EMU68_UNIT_MAX_PAGES)
+        return;
+
+    for (uint32_t page = first_page; page <= last_page; page++)
+    {
+        if (smc_pages[page >> 5] & (1 << (page & 31)))
+            continue;
+
+        if (mmu_protect_page(page << 12, 1))
+            smc_pages[page >> 5] |= 1 << (page & 31);
+    }
+#else
+    (void)unit;
+#endif
+}
+
+/*
+    Called from the page fault handler on write to a read-only page. If the page was protected
+    because of translated code, all units overlapping it are soft flushed and the page becomes
+    writable again. Returns 1 if the write shall be repeated, 0 if the fault was not caused by
+    the protection.
+*/
+int M68K_CodePageWritten(uint32_t address)
+{
+#if EMU68_SMC_PROTECT
+    uint32_t page = address >> 12;
+    struct M68KUnitPage *up;
+
+    if (!(smc_pages[page >> 5] & (1 << (page & 31))))
+        return 0;
+
+    smc_pages[page >> 5] &= ~(1 << (page & 31));
+    mmu_protect_page(page << 12, 0);
+
+    ForeachNode(M68K_GetPageUnits(page), up)
+    {
+        struct M68KTranslationUnit *unit = up->up_Unit;
+
+        if (up->up_Page == page && ((uintptr_t)unit->mt_ARMEntryPoint >> 56) != 0xaa)
+            M68K_SoftFlushUnit(unit);
+    }
+
+    asm volatile("msr tpidr_el1, %0"::"r"(0xffffffff));
+
+    return 1;
+#else
+    (void)address;
+    return 0;
+#endif
+}
+
+void M68K_RemoveUnit(struct M68KTranslationUnit *unit)
+{
+    uint32_t address = (uint32_t)(uintptr_t)unit->mt_M68kAddress;
+
+    for (unsigned i=0; i < unit->mt_PageCount; i++)
+        REMOVE(&unit->mt_Pages[i].up_Node);
+
+    for (uint32_t i = UnitTableStart(unit->mt_M68kAddress); ; i = (i + 1) % EMU68_UNIT_TABLE_SIZE)
+    {
+        if (UnitTable[i].us_M68kAddress == UNIT_SLOT_EMPTY)
+            return;
+
+        if (UnitTable[i].us_M68kAddress == address && UnitTable[i].us_Unit == unit)
+        {
+            UnitTable[i].us_M68kAddress = UNIT_SLOT_DELETED;
+            unit_table_used--;
+            unit_table_deleted++;
+            return;
+        }
+    }
+}
+
+static inline uint32_t LinkHash(uint16_t *m68k_target)
+{
+    return ((uintptr_t)m68k_target >> EMU68_HASHSHIFT) & EMU68_LINK_HASHMASK;
+}
+
+static void M68K_PatchLink(struct M68KUnitLink *link, struct M68KTranslationUnit *target)
+{
+    if (target)
+        *link->ml_Slot = b(&target->mt_ARMCode[0] - link->ml_Slot);
+    else
+        *link->ml_Slot = bx_lr();
+
+    link->ml_Target = target;
+
+    arm_flush_cache((uintptr_t)link->ml_Slot, 4);
+    arm_icache_invalidate((uintptr_t)link->ml_Slot | 0x0000001000000000ULL, 4);
+}
+
+static struct M68KTranslationUnit *M68K_FindLinkTarget(uint16_t *m68k_target)
+{
+    struct M68KTranslationUnit *unit = M68K_FindUnit(m68k_target);
+
+    /* Soft flushed units have to pass through the dispatcher for verification */
+    if (unit && ((uintptr_t)unit->mt_ARMEntryPoint >> 56) == 0xaa)
+        return NULL;
+
+    return unit;
+}
+
+/*
+    Chain the unit with the rest of JIT cache. Exits of the unit are patched to branch directly
+    into their target units, if these are already translated, and all pending exits of other
+    units targeting this one are patched to branch into it.
+*/
+void M68K_LinkUnit(struct M68KTranslationUnit *unit)
+{
+    struct M68KUnitLink *link, *next;
+    struct M68KTranslationUnit *target;
+
+    if (!(__m68k_state->JIT_CONTROL2 & JC2F_CHAIN_UNITS))
+        return;
+
+    for (unsigned i=0; i < unit->mt_LinkCount; i++)
+    {
+        link = &unit->mt_Links[i];
+
+        if (link->ml_Target == NULL && (target = M68K_FindLinkTarget(link->ml_M68kTarget)) != NULL)
+        {
+            REMOVE(&link->ml_Node);
+            ADDHEAD(&target->mt_Incoming, &link->ml_Node);
+            M68K_PatchLink(link, target);
+        }
+    }
+
+    ForeachNodeSafe(&PendingLinks[LinkHash(unit->mt_M68kAddress)], link, next)
+    {
+        if (link->ml_M68kTarget == unit->mt_M68kAddress)
+        {
+            REMOVE(&link->ml_Node);
+            ADDHEAD(&unit->mt_Incoming, &link->ml_Node);
+            M68K_PatchLink(link, unit);
+        }
+    }
+}
+
+/*
+    Revert all direct branches into and out of the unit back to returns to the dispatcher. If
+    discard is set, the unit is about to be released and its own exits are forgotten, otherwise
+    they are put back on the pending list and can be chained again by M68K_LinkUnit.
+*/
+void M68K_UnlinkUnit(struct M68KTranslationUnit *unit, int discard)
+{
+    struct M68KUnitLink *link;
+
+    /* Pending branch cache miss, return stack entries and retranslation request may refer to the unit being released */
+    if (discard)
+    {
+        __m68k_state->JIT_BRANCH_SITE = 0;
+        __m68k_state->JIT_RETURN_DEPTH = 0;
+
+        if (__m68k_state->JIT_TIER_UNIT == (uintptr_t)&unit->mt_UseCount)
+            __m68k_state->JIT_TIER_UNIT = 0;
+    }
+
+    while ((link = (struct M68KUnitLink *)REMHEAD(&unit->mt_Incoming)))
+    {
+        M68K_PatchLink(link, NULL);
+        ADDHEAD(&PendingLinks[LinkHash(link->ml_M68kTarget)], &link->ml_Node);
+
+#if EMU68_SIDE_ENTRIES
+        /*
+            Side entry unit returning to the dispatcher would be found again at the same PC. Make it
+            fault into verification instead, where it is released.
+        */
+        if (link->ml_M68kTarget == SIDE_ENTRY_LINK)
+        {
+            M68K_SoftFlushUnit(link->ml_Unit);
+            asm volatile("msr tpidr_el1, %0"::"r"(0xffffffff));
+        }
+#endif
+    }
+
+    for (unsigned i=0; i < unit->mt_LinkCount; i++)
+    {
+        link = &unit->mt_Links[i];
+
+        REMOVE(&link->ml_Node);
+
+        if (link->ml_Target)
+            M68K_PatchLink(link, NULL);
+
+        if (!discard)
+            ADDHEAD(&PendingLinks[LinkHash(link->ml_M68kTarget)], &link->ml_Node);
+    }
+}
+
+/*
+    Move unit to new place in JIT memory, which may overlap the old one. Links of the unit are built
+    again, links from other units are restored by M68K_LinkUnit once the unit is in place.
+*/
+void M68K_MoveUnit(struct M68KTranslationUnit *unit, struct M68KTranslationUnit *copy)
+{
+    intptr_t delta = (uintptr_t)copy - (uintptr_t)unit;
+    uint32_t code_size = (uintptr_t)unit->mt_Links - (uintptr_t)&unit->mt_ARMCode[0];
+
+#if EMU68_BACKGROUND_VERIFY
+    Verify_Cancel(unit);
+#endif
+    M68K_UnlinkUnit(unit, 1);
+    REMOVE(&unit->mt_LRUNode);
+    M68K_RemoveUnit(unit);
+
+    memmove(copy, unit, unit->mt_AllocSize & ~63);
+
+    copy->mt_ARMEntryPoint = (void *)((uintptr_t)copy->mt_ARMEntryPoint + delta);
+    copy->mt_Links = (struct M68KUnitLink *)((uintptr_t)copy->mt_Links + delta);
+    copy->mt_Pages = (struct M68KUnitPage *)((uintptr_t)copy->mt_Pages + delta);
+    copy->mt_Entries = (struct M68KSideEntry *)((uintptr_t)copy->mt_Entries + delta);
+    if (copy->mt_PCMap)
+        copy->mt_PCMap = (struct M68KPCMap *)((uintptr_t)copy->mt_PCMap + delta);
+    copy->mt_VerifySlot = 0;
+    NEWLIST(&copy->mt_Incoming);
+
+    for (unsigned i=0; i < copy->mt_LinkCount; i++)
+    {
+        struct M68KUnitLink *link = &copy->mt_Links[i];
+
+        link->ml_Slot = (uint32_t *)((uintptr_t)link->ml_Slot + delta);
+        link->ml_Target = NULL;
+        link->ml_Unit = copy;
+        ADDHEAD(&PendingLinks[LinkHash(link->ml_M68kTarget)], &link->ml_Node);
+    }
+    for (unsigned i=0; i + 1 < copy->mt_LinkCount; i++)
+    {
+        struct M68KUnitLink *link = &copy->mt_Links[i];
+
+        /* Site pointer of inline branch cache points to its first link */
+        if (*(uint64_t *)&link->ml_Slot[4] == (uintptr_t)link - delta)
+        {
+            *(uint64_t *)&link->ml_Slot[4] = (uintptr_t)link;
+            i++;
+        }
+    }
+
+    ADDHEAD(&LRU, &copy->mt_LRUNode);
+    M68K_InsertUnit(copy);
+
+    arm_flush_cache((uintptr_t)&copy->mt_ARMCode, code_size);
+    arm_icache_invalidate((intptr_t)copy->mt_ARMEntryPoint, code_size);
+
+    M68K_LinkUnit(copy);
+
+    asm volatile("msr tpidr_el1, %0"::"r"(0xffffffff));
+}
+
+/*
+    Weak flush of the unit. Its entry address becomes invalid and all links are reverted, so that
+    the unit faults into verification of its checksum when entered next time.
+*/
+void M68K_SoftFlushUnit(struct M68KTranslationUnit *unit)
+{
+    uintptr_t e;
+
+#if EMU68_BACKGROUND_VERIFY
+    /* Worker must not clear the tag set here based on older check */
+    Verify_Cancel(unit);
+#endif
+
+    e = (uintptr_t)unit->mt_ARMEntryPoint;
+    e &= 0x00ffffffffffffffULL;
+    e |= 0xaa00000000000000ULL;
+    unit->mt_ARMEntryPoint = (void *)e;
+
+    M68K_UnlinkUnit(unit, 0);
+}
+
+/* Weak flush of all units in the cache. If enabled, worker on a spare core verifies them in background */
+void M68K_SoftFlushAll()
+{
+    struct Node *n;
+#if EMU68_BACKGROUND_VERIFY
+    int queue = __atomic_load_n(&verify_worker, __ATOMIC_ACQUIRE) && (__m68k_state->JIT_CONTROL2 & JC2F_BG_VERIFY);
+
+    Verify_Restart();
+#endif
+
+    ForeachNode(&LRU, n)
+    {
+        struct M68KTranslationUnit *unit = (struct M68KTranslationUnit *)((uintptr_t)n - __builtin_offsetof(struct M68KTranslationUnit, mt_LRUNode));
+
+        M68K_SoftFlushUnit(unit);
+#if EMU68_BACKGROUND_VERIFY
+        if (queue)
+            Verify_Queue(unit);
+#endif
+    }
+
+#if EMU68_BACKGROUND_VERIFY
+    if (verify_top != 0)
+        asm volatile("dsb ish; sev");
+#endif
+}
+
+#if EMU68_WARM_RESET
+/*
+    Prepare the cache for a restart of m68k code from the reset vector. ROM is mapped read-only at
+    boot and cannot change before Emu68 is restarted, so units translated from it are kept as they
+    are, links between them included. All other units are soft flushed and get their checksum
+    verified when entered next time, or by the worker on a spare core.
+*/
+void M68K_ResetCache()
+{
+    struct Node *n;
+    uint32_t kept = 0;
+    uint32_t flushed = 0;
+#if EMU68_BACKGROUND_VERIFY
+    int queue = __atomic_load_n(&verify_worker, __ATOMIC_ACQUIRE) && (__m68k_state->JIT_CONTROL2 & JC2F_BG_VERIFY);
+
+    Verify_Restart();
+#endif
+
+    ForeachNode(&LRU, n)
+    {
+        struct M68KTranslationUnit *unit = (struct M68KTranslationUnit *)((uintptr_t)n - __builtin_offsetof(struct M68KTranslationUnit, mt_LRUNode));
+
+        if (M68K_IsROM((uint32_t)(uintptr_t)unit->mt_M68kLow, (uint32_t)(uintptr_t)unit->mt_M68kHigh))
+        {
+            kept++;
+            continue;
+        }
+
+        M68K_SoftFlushUnit(unit);
+        flushed++;
+#if EMU68_BACKGROUND_VERIFY
+        if (queue)
+            Verify_Queue(unit);
+#endif
+    }
+
+#if EMU68_BACKGROUND_VERIFY
+    if (verify_top != 0)
+        asm volatile("dsb ish; sev");
+#endif
+
+    /* Return stack and branch cache miss belong to code of the previous run */
+    __m68k_state->JIT_BRANCH_SITE = 0;
+    __m68k_state->JIT_RETURN_DEPTH = 0;
+
+    kprintf("[ICache] Warm reset, %d ROM units kept, %d units soft flushed\n", kept, flushed);
+}
+#endif
+
+static void M68K_SetBranchCacheEntry(struct M68KUnitLink *link, uint16_t *m68k_target, struct M68KTranslationUnit *target)
+{
+    REMOVE(&link->ml_Node);
+
+    link->ml_M68kTarget = m68k_target;
+    link->ml_Slot[2] = (uint32_t)(uintptr_t)m68k_target;
+
+    if (target)
+        ADDHEAD(&target->mt_Incoming, &link->ml_Node);
+    else
+        ADDHEAD(&PendingLinks[LinkHash(m68k_target)], &link->ml_Node);
+
+    M68K_PatchLink(link, target);
+}
+
+/*
+    Called by the dispatcher after a miss in inline branch cache. The unit is put into the first
+    entry of the site, previous content of the first entry moves to the second one.
+*/
+void M68K_UpdateBranchCache(struct M68KUnitLink *site, struct M68KTranslationUnit *unit)
+{
+    struct M68KTranslationUnit *target = unit;
+
+    if (!(__m68k_state->JIT_CONTROL2 & JC2F_BRANCH_CACHE))
+        return;
+
+    /* Soft flushed unit stays pending until it is verified */
+    if (((uintptr_t)unit->mt_ARMEntryPoint >> 56) == 0xaa)
+        target = NULL;
+
+    if (site[0].ml_M68kTarget != BRANCH_CACHE_EMPTY)
+        M68K_SetBranchCacheEntry(&site[1], site[0].ml_M68kTarget, site[0].ml_Target);
+
+    M68K_SetBranchCacheEntry(&site[0], unit->mt_M68kAddress, target);
+}
+
+/*
+    Select the unit to be evicted. The LRU list is swept like a clock, with the hand at its tail.
+    A unit entered since the hand passed it last time has its reference bit cleared and moves to
+    the head of the list, the first unit without reference is returned. After one revolution all
+    bits are clear, so the sweep is bounded by the number of units.
+*/
+static struct M68KTranslationUnit *M68K_ClockVictim()
+{
+    struct Node *n;
+#if EMU68_PIN_UNITS
+    uint32_t pinned = 0;
+#endif
+
+    while ((n = REMTAIL(&LRU)))
+    {
+        struct M68KTranslationUnit *unit = (struct M68KTranslationUnit *)((uintptr_t)n - __builtin_offsetof(struct M68KTranslationUnit, mt_LRUNode));
+
+#if EMU68_SIDE_ENTRIES
+        if (unit == entry_owner)
+        {
+            ADDHEAD(&LRU, &unit->mt_LRUNode);
+
+            if (GetTail(&LRU) == n)
+                return NULL;
+
+            continue;
+        }
+#endif
+
+#if EMU68_PIN_UNITS
+        /* Pinned units are passed until the hand went around the whole list */
+        if (!IsListEmpty(&LRU) && pinned < __m68k_state->JIT_UNIT_COUNT && M68K_IsPinned(unit))
+        {
+            pinned++;
+            ADDHEAD(&LRU, &unit->mt_LRUNode);
+            continue;
+        }
+#endif
+
+        if (!M68K_IsReferenced(unit) || IsListEmpty(&LRU))
+            return unit;
+
+        unit->mt_Referenced = 0;
+        ADDHEAD(&LRU, &unit->mt_LRUNode);
+    }
+
+    return NULL;
+}
+
+#if EMU68_SIDE_ENTRIES
+/* Find unit in the cache which has a side entry at given m68k address */
+static struct M68KTranslationUnit *M68K_FindSideEntry(uint16_t *m68k_address, struct M68KSideEntry **entry)
+{
+    uint32_t page = (uint32_t)(uintptr_t)m68k_address >> 12;
+    struct M68KUnitPage *up;
+
+    ForeachNode(M68K_GetPageUnits(page), up)
+    {
+        struct M68KTranslationUnit *unit = up->up_Unit;
+        uint32_t offset = m68k_address - unit->mt_M68kLow;
+
+        if (up->up_Page != page || m68k_address < unit->mt_M68kLow || m68k_address >= unit->mt_M68kHigh)
+            continue;
+
+        for (uint32_t i=0; i < unit->mt_EntryCount; i++)
+        {
+            if (unit->mt_Entries[i].se_M68kOffset != offset)
+                continue;
+
+            /* Soft flushed unit is verified the same way as if it was entered */
+            if (((uintptr_t)unit->mt_ARMEntryPoint >> 56) == 0xaa)
+            {
+                if (M68K_VerifyUnit(unit) == NULL)
+                    return NULL;
+
+                unit->mt_ARMEntryPoint = (void *)((uintptr_t)&unit->mt_ARMCode[0] | 0x0000001000000000ULL);
+                M68K_ProtectUnitPages(unit);
+                M68K_LinkUnit(unit);
+            }
+
+            *entry = &unit->mt_Entries[i];
+            return unit;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+    Emit code of a unit starting at the side entry of the owner unit. It brings the PC register and
+    the instruction counter to the state expected at the entry, the branch into the owner is the only
+    link of the unit and is patched once the unit is allocated.
+*/
+static uintptr_t M68K_EmitSideEntry(struct M68KTranslationUnit *owner, struct M68KSideEntry *entry)
+{
+    uint32_t *end = temporary_arm_code;
+
+    insn_count = 0;
+    entry_count = 0;
+#if EMU68_LAZY_PC
+    pc_map_count = 0;
+#endif
+    prologue_size = 0;
+    epilogue_size = 0;
+    conditionals_count = 0;
+    m68k_low = owner->mt_M68kLow;
+    m68k_high = owner->mt_M68kHigh;
+
+    if (entry->se_PCRel > 0)
+        *end++ = sub_immed(REG_PC, REG_PC, entry->se_PCRel);
+    else if (entry->se_PCRel < 0)
+        *end++ = add_immed(REG_PC, REG_PC, -entry->se_PCRel);
+
+#if EMU68_INSN_COUNTER
+    /* Exits of the owner count the instructions from its beginning */
+    *end++ = movn64_immed_u16(0, entry->se_InsnCount - 1, 0);
+    *end++ = fmov_from_reg(0, 0);
+    *end++ = vadd_2d(30, 30, 0);
+#endif
+
+    link_offset[0] = end - temporary_arm_code;
+    link_target[0] = SIDE_ENTRY_LINK;
+    link_source[0] = NULL;
+    link_counter[0] = 0;
+    link_count = 1;
+    *end++ = bx_lr();
+
+    *end++ = 0xffffffff;
+
+    return (uintptr_t)end - (uintptr_t)temporary_arm_code;
+}
+#endif
+
+/* Fill link records of new unit from exits recorded in link_offset, link_target and friends */
+static void M68K_SetupLinks(struct M68KTranslationUnit *unit)
+{
+    for (unsigned i=0; i < link_count; i++)
+    {
+        struct M68KUnitLink *link = &unit->mt_Links[i];
+
+        link->ml_Slot = &unit->mt_ARMCode[link_offset[i]];
+        link->ml_M68kTarget = link_target[i];
+        link->ml_Target = NULL;
+        link->ml_Misses = 0;
+        link->ml_Count = 0;
+        link->ml_M68kSource = link_source[i];
+        link->ml_Unit = unit;
+        ADDHEAD(&PendingLinks[LinkHash(link_target[i])], &link->ml_Node);
+
+        /* Point exit counter of the first tier unit to the link record */
+        if (link_counter[i])
+        {
+            intptr_t offset = (uintptr_t)&link->ml_Count - (uintptr_t)&unit->mt_ARMCode[link_counter[i]];
+            uint32_t insn = LE32(unit->mt_ARMCode[link_counter[i]]);
+
+            unit->mt_ARMCode[link_counter[i]] = adr(insn & 31, offset);
+        }
+    }
+    for (unsigned i=0; i < link_count; i++)
+    {
+        /* Inline branch cache sites come in pairs of links. Fill the site pointer in */
+        if (link_target[i] == BRANCH_CACHE_EMPTY)
+        {
+            *(uint64_t *)&unit->mt_ARMCode[link_offset[i] + 4] = (uintptr_t)&unit->mt_Links[i];
+            i++;
+        }
+    }
+}
+
+/*
+    Get M68K code unit from the instruction cache. Return NULL if code was not found and needs to be
+    translated first.
+
+    Units are evicted by M68K_ClockVictim, the lookup itself only sets the reference bit.
+*/
+struct M68KTranslationUnit *M68K_GetTranslationUnit(uint16_t *m68kcodeptr)
+{
+    struct M68KTranslationUnit *unit = NULL; //, *n;
+    uintptr_t hash = (uintptr_t)m68kcodeptr;
+    uint16_t *orig_m68kcodeptr = m68kcodeptr;
+    
+    int debug = 0;
+
+    if ((uint32_t)(uintptr_t)m68kcodeptr >= debug_range_min && (uint32_t)(uintptr_t)m68kcodeptr <= debug_range_max) {
+        debug = globalDebug();
+    }
+
+    /* Line of the unit lookup table where the search starts */
+    hash = UnitTableStart(m68kcodeptr) / 4;
+
+    if (debug > 2)
+        kprintf("[ICache] GetTranslationUnit(%08x)\n[ICache] Table line: 0x%04x\n", (void*)m68kcodeptr, (int)hash);
+
+#if EMU68_BACKGROUND_VERIFY
+    Verify_Collect();
+#endif
+
+    if (unit == NULL)
+    {
+        int tier = 0;
+
+#if EMU68_TIERED_JIT
+        if (promote_unit)
+            tier = 2;
+        else if (__m68k_state->JIT_CONTROL2 & JC2F_TIERED_JIT)
+            tier = 1;
+#endif
+
+#if EMU68_JIT_ARENA
+        /* Code is emitted directly into the unit at the head of the arena */
+        unit = Arena_Reserve();
+        temporary_arm_code = &unit->mt_ARMCode[0];
+#else
+        temporary_arm_code = scratch_arm_code;
+#endif
+
+        uintptr_t line_length;
+        uint32_t side_count = 0;
+#if EMU68_SIDE_ENTRIES
+        struct M68KSideEntry *entry = NULL;
+
+        /* Address inside of a unit which is in the cache already. Enter the existing code there */
+        entry_owner = NULL;
+        if (!promote_unit && (__m68k_state->JIT_CONTROL2 & JC2F_SIDE_ENTRIES))
+            entry_owner = M68K_FindSideEntry(m68kcodeptr, &entry);
+
+        if (entry_owner)
+        {
+            line_length = M68K_EmitSideEntry(entry_owner, entry);
+
+            if (debug)
+                kprintf("[ICache]   Side entry into unit %p at ARM offset %d\n", (void*)entry_owner, entry->se_ARMOffset);
+        }
+        else
+#endif
+            line_length = M68K_Translate(m68kcodeptr, tier);
+        uintptr_t arm_insn_count = line_length/4 - 1;
+
+#if EMU68_SIDE_ENTRIES
+        /* Keep side entries which can be encoded relative to the final m68k range */
+        for (uint32_t i=0; i < entry_count; i++)
+        {
+            uintptr_t offset = entry_m68k[i] - m68k_low;
+
+            if (offset <= 0xffff)
+            {
+                entry_state[side_count] = entry_state[i];
+                entry_state[side_count].se_M68kOffset = offset;
+                side_count++;
+            }
+        }
+#endif
+
+        uintptr_t links_offset = (line_length + 7) & ~7;
+        uintptr_t pages_offset = links_offset + link_count * sizeof(struct M68KUnitLink);
+        uint32_t page_count = UnitPageCount(m68k_low, m68k_high);
+        uintptr_t entries_offset = pages_offset + page_count * sizeof(struct M68KUnitPage);
+        uintptr_t pc_map_offset = entries_offset + side_count * sizeof(struct M68KSideEntry);
+        uint32_t pc_map_length = 0;
+#if EMU68_LAZY_PC
+        pc_map_length = pc_map_count;
+#endif
+        uintptr_t unit_length = (pc_map_offset + pc_map_length * sizeof(struct M68KPCMap) + 63 + sizeof(struct M68KTranslationUnit)) & ~63;
+
+        /* Unit lookup table is full, make place by removing units not referenced recently */
+        while (unit_table_used >= EMU68_UNIT_TABLE_LIMIT - 1)
+        {
+            struct M68KTranslationUnit *ptr = M68K_ClockVictim();
+
+            if (ptr == NULL)
+                break;
+
+            M68K_UnlinkUnit(ptr, 1);
+            M68K_RemoveUnit(ptr);
+            M68K_FreeUnit(ptr);
+            __m68k_state->JIT_UNIT_COUNT--;
+
+            asm volatile("msr tpidr_el1, %0"::"r"(0xffffffff));
+        }
+
+#if EMU68_JIT_ARENA
+        Arena_Commit(unit, unit_length);
+        __m68k_state->JIT_CACHE_FREE = M68K_GetCacheFree();
+#else
+        do {
+            unit = tlsf_malloc_aligned(jit_tlsf, unit_length, 64);
+
+            __m68k_state->JIT_CACHE_FREE = M68K_GetCacheFree();
+
+            /* Take more memory for the JIT pool before evicting anything */
+            if (unit == NULL && M68K_GrowCache())
+                continue;
+
+            if (unit == NULL)
             {
                 if (debug > 0) {
                     kprintf("[ICache] Requested block was %d bytes long\n", unit_length);
                 }
 
                 for (int i=0; i < 8; i++) {
-                    struct Node *n = REMTAIL(&LRU);
+                    struct M68KTranslationUnit *ptr = M68K_ClockVictim();
 
-                    if (n == NULL)
+                    if (ptr == NULL)
                         break;
 
-                    void *ptr = (char *)n - __builtin_offsetof(struct M68KTranslationUnit, mt_LRUNode);
-                    REMOVE((struct Node *)ptr);
+                    M68K_UnlinkUnit(ptr, 1);
+                    M68K_RemoveUnit(ptr);
                     if (debug > 0)
                     {    
-                        kprintf("[ICache] Run out of cache. Removing least recently used cache line node @ %p\n", ptr);
+                        kprintf("[ICache] Run out of cache. Removing unreferenced unit @ %p\n", ptr);
                     }
-                    tlsf_free(jit_tlsf, ptr);
+                    M68K_FreeUnit(ptr);
                     __m68k_state->JIT_UNIT_COUNT--;
                 }
-                __m68k_state->JIT_CACHE_FREE = tlsf_get_free_size(jit_tlsf);
                 
                 asm volatile("msr tpidr_el1, %0"::"r"(0xffffffff));
             }
         } while(unit == NULL);
+#endif
 
         unit->mt_ARMEntryPoint = &unit->mt_ARMCode[0];
         unit->mt_ARMEntryPoint = (void *)((uintptr_t)unit->mt_ARMEntryPoint | 0x0000001000000000ULL);
@@ -698,6 +2609,9 @@ struct M68KTranslationUnit *M68K_GetTranslationUnit(uint16_t *m68kcodeptr)
         unit->mt_ARMInsnCnt = arm_insn_count;
         unit->mt_UseCount = 0;
         unit->mt_FetchCount = 0;
+        unit->mt_Referenced = 1;
+        unit->mt_Tier = tier;
+        unit->mt_VerifySlot = 0;
         unit->mt_M68kAddress = orig_m68kcodeptr;
         unit->mt_M68kLow = m68k_low;
         unit->mt_M68kHigh = m68k_high;
@@ -705,10 +2619,49 @@ struct M68KTranslationUnit *M68K_GetTranslationUnit(uint16_t *m68kcodeptr)
         unit->mt_PrologueSize = prologue_size;
         unit->mt_EpilogueSize = epilogue_size;
         unit->mt_Conditionals = conditionals_count;
+#if !EMU68_JIT_ARENA
         DuffCopy(&unit->mt_ARMCode[0], temporary_arm_code, line_length/4);
+#endif
+
+        NEWLIST(&unit->mt_Incoming);
+        unit->mt_LinkCount = link_count;
+        unit->mt_Links = (struct M68KUnitLink *)((uintptr_t)&unit->mt_ARMCode[0] + links_offset);
+        unit->mt_PageCount = page_count;
+        unit->mt_Pages = (struct M68KUnitPage *)((uintptr_t)&unit->mt_ARMCode[0] + pages_offset);
+        unit->mt_EntryCount = side_count;
+        unit->mt_Entries = (struct M68KSideEntry *)((uintptr_t)&unit->mt_ARMCode[0] + entries_offset);
+#if EMU68_SIDE_ENTRIES
+        for (unsigned i=0; i < side_count; i++)
+            unit->mt_Entries[i] = entry_state[i];
+#endif
+        unit->mt_PCMapCount = pc_map_length;
+        unit->mt_PCMap = (struct M68KPCMap *)((uintptr_t)&unit->mt_ARMCode[0] + pc_map_offset);
+#if EMU68_LAZY_PC
+        for (unsigned i=0; i < pc_map_length; i++)
+            unit->mt_PCMap[i] = pc_map[i];
+#endif
+        M68K_SetupLinks(unit);
+
+#if EMU68_SIDE_ENTRIES
+        /* Side entry unit branches into the owner directly. The link goes away with either of them */
+        if (entry_owner)
+        {
+            struct M68KUnitLink *link = &unit->mt_Links[0];
+
+            REMOVE(&link->ml_Node);
+            ADDHEAD(&entry_owner->mt_Incoming, &link->ml_Node);
+            link->ml_Target = entry_owner;
+            *link->ml_Slot = b(&entry_owner->mt_ARMCode[entry->se_ARMOffset] - link->ml_Slot);
+
+            unit->mt_CRC32 = entry_owner->mt_CRC32;
+            entry_owner = NULL;
+        }
+#endif
 
         ADDHEAD(&LRU, &unit->mt_LRUNode);
-        ADDHEAD(&ICache[hash], &unit->mt_HashNode);
+        M68K_InsertUnit(unit);
+
+        M68K_ProtectUnitPages(unit);
 
         __m68k_state->JIT_UNIT_COUNT++;
         __m68k_state->JIT_CACHE_MISS++;
@@ -721,6 +2674,8 @@ struct M68KTranslationUnit *M68K_GetTranslationUnit(uint16_t *m68kcodeptr)
         arm_flush_cache((uintptr_t)&unit->mt_ARMCode, line_length);
         arm_icache_invalidate((intptr_t)unit->mt_ARMEntryPoint, line_length);
 
+        M68K_LinkUnit(unit);
+
         if (debug)
         {
             kprintf("-- ARM Code dump --\n");
@@ -758,6 +2713,388 @@ struct M68KTranslationUnit *M68K_GetTranslationUnit(uint16_t *m68kcodeptr)
     return unit;
 }
 
+/*
+    Replace first tier unit which became hot with new translation done with full depth, inline
+    range, CCR scan and loop unrolling. Links pointing to the old unit are moved to the new one.
+*/
+struct M68KTranslationUnit *M68K_PromoteUnit(struct M68KTranslationUnit *unit)
+{
+    uint16_t *m68kcodeptr = unit->mt_M68kAddress;
+
+    /* Keep the exit profile of the first tier unit, the new translation will use it */
+    profile_count = 0;
+    profile_entries = unit->mt_UseCount;
+    for (unsigned i=0; i < unit->mt_LinkCount; i++)
+    {
+        struct M68KUnitLink *link = &unit->mt_Links[i];
+
+        if (link->ml_M68kSource != NULL && link->ml_Count != 0)
+        {
+            profile_source[profile_count] = link->ml_M68kSource;
+            profile_exits[profile_count] = link->ml_Count;
+            profile_count++;
+        }
+    }
+
+    M68K_UnlinkUnit(unit, 1);
+    M68K_RemoveUnit(unit);
+    REMOVE(&unit->mt_LRUNode);
+    M68K_FreeUnit(unit);
+    __m68k_state->JIT_UNIT_COUNT--;
+
+    promote_unit = 1;
+    unit = M68K_GetTranslationUnit(m68kcodeptr);
+    promote_unit = 0;
+    profile_count = 0;
+
+    return unit;
+}
+
+/*
+    Check the profile of the unit being promoted. Returns non-zero if the first tier unit was left
+    through the exit of currently translated instruction on more than half of its entries. The
+    translator lays such instruction out the other way round, the frequent side is followed and
+    the rare one becomes the exit.
+*/
+int M68K_IsHotExit()
+{
+    uint64_t exits = 0;
+
+    if (!promote_unit || exit_source == NULL)
+        return 0;
+
+    for (unsigned i=0; i < profile_count; i++)
+    {
+        if (profile_source[i] == exit_source)
+            exits += profile_exits[i];
+    }
+
+    return 2 * exits > profile_entries;
+}
+
+#if EMU68_JIT_SNAPSHOT
+/*
+    Snapshot of JIT units translated from Kickstart ROM. The snapshot is written into m68k memory
+    on request and can be appended to the ROM image, where it is found by the footer at the end.
+    During next boot units whose checksum still matches the ROM are put into the cache before
+    the first m68k instruction runs.
+
+    Layout: header, unit records, footer. Every unit record is followed by ARM code up to the link
+    records (layout of the unit is kept, so that code addressing its links stays valid), exits of
+    the unit, side entries and the PC map. Exits are stored unchained and inline branch caches are empty. The
+    code is bound to the Emu68 binary and the JIT settings it was created with.
+*/
+#define SNAPSHOT_MAGIC      0x4a495453  /* JITS */
+#define SNAPSHOT_VERSION    2
+
+struct SnapshotHeader {
+    uint32_t    sh_Magic;
+    uint32_t    sh_Version;
+    uint32_t    sh_BuildID;     /* Checksum of build ID of Emu68 */
+    uint32_t    sh_Control;     /* JITCTRL and JITCTRL2 the units were translated with */
+    uint32_t    sh_Control2;
+    uint32_t    sh_UnitCount;
+};
+
+struct SnapshotUnit {
+    uint32_t    su_Size;        /* Size of the record including code, exits and entries */
+    uint32_t    su_M68kAddress;
+    uint32_t    su_M68kLow;
+    uint32_t    su_M68kHigh;
+    uint32_t    su_CRC32;
+    uint32_t    su_CodeSize;
+    uint32_t    su_M68kInsnCnt;
+    uint32_t    su_ARMInsnCnt;
+    uint32_t    su_PrologueSize;
+    uint32_t    su_EpilogueSize;
+    uint32_t    su_Conditionals;
+    uint16_t    su_LinkCount;
+    uint16_t    su_EntryCount;
+    uint16_t    su_PCMapCount;
+    uint8_t     su_Tier;
+    uint8_t     su_Pad;
+};
+
+struct SnapshotLink {
+    uint32_t    sl_Offset;      /* Slot of the exit in ARM code, in words */
+    uint32_t    sl_M68kTarget;
+    uint32_t    sl_M68kSource;
+};
+
+struct SnapshotFooter {
+    uint32_t    sf_Size;        /* Size of entire snapshot */
+    uint32_t    sf_Magic;
+};
+
+static uint32_t Snapshot_BuildID()
+{
+    extern const struct BuildID g_note_build_id;
+    const uint8_t *id = &g_note_build_id.bid_Data[g_note_build_id.bid_NameLen];
+
+    return CalcCRC32((void *)id, (void *)(id + g_note_build_id.bid_DescLen));
+}
+
+/* Write snapshot of all valid units translated from ROM at given address. Returns its size */
+uint32_t M68K_SaveSnapshot(uint32_t address)
+{
+    struct SnapshotHeader *header = (struct SnapshotHeader *)(uintptr_t)address;
+    struct SnapshotFooter *footer;
+    uint8_t *ptr = (uint8_t *)&header[1];
+    struct Node *n;
+    uint32_t count = 0;
+
+    ForeachNode(&LRU, n)
+    {
+        struct M68KTranslationUnit *unit = (struct M68KTranslationUnit *)((uintptr_t)n - __builtin_offsetof(struct M68KTranslationUnit, mt_LRUNode));
+        struct SnapshotUnit *su = (struct SnapshotUnit *)ptr;
+        struct SnapshotLink *sl;
+        uint32_t *code = (uint32_t *)&su[1];
+        uint32_t code_size = (uintptr_t)unit->mt_Links - (uintptr_t)&unit->mt_ARMCode[0];
+
+        if (!M68K_IsROM((uint32_t)(uintptr_t)unit->mt_M68kLow, (uint32_t)(uintptr_t)unit->mt_M68kHigh))
+            continue;
+
+        /* Soft flushed units may be stale, side entry units depend on another unit */
+        if (((uintptr_t)unit->mt_ARMEntryPoint >> 56) == 0xaa)
+            continue;
+#if EMU68_SIDE_ENTRIES
+        if (unit->mt_LinkCount != 0 && unit->mt_Links[0].ml_M68kTarget == SIDE_ENTRY_LINK)
+            continue;
+#endif
+
+        su->su_M68kAddress = (uint32_t)(uintptr_t)unit->mt_M68kAddress;
+        su->su_M68kLow = (uint32_t)(uintptr_t)unit->mt_M68kLow;
+        su->su_M68kHigh = (uint32_t)(uintptr_t)unit->mt_M68kHigh;
+        su->su_CRC32 = unit->mt_CRC32;
+        su->su_CodeSize = code_size;
+        su->su_M68kInsnCnt = unit->mt_M68kInsnCnt;
+        su->su_ARMInsnCnt = unit->mt_ARMInsnCnt;
+        su->su_PrologueSize = unit->mt_PrologueSize;
+        su->su_EpilogueSize = unit->mt_EpilogueSize;
+        su->su_Conditionals = unit->mt_Conditionals;
+        su->su_LinkCount = unit->mt_LinkCount;
+        su->su_EntryCount = unit->mt_EntryCount;
+        su->su_PCMapCount = unit->mt_PCMapCount;
+        su->su_Tier = unit->mt_Tier;
+        su->su_Pad = 0;
+
+        memcpy(code, &unit->mt_ARMCode[0], code_size);
+        sl = (struct SnapshotLink *)((uintptr_t)code + code_size);
+
+        for (unsigned i=0; i < unit->mt_LinkCount; i++)
+        {
+            struct M68KUnitLink *link = &unit->mt_Links[i];
+
+            sl[i].sl_Offset = link->ml_Slot - &unit->mt_ARMCode[0];
+            sl[i].sl_M68kTarget = (uint32_t)(uintptr_t)link->ml_M68kTarget;
+            sl[i].sl_M68kSource = (uint32_t)(uintptr_t)link->ml_M68kSource;
+            code[sl[i].sl_Offset] = bx_lr();
+        }
+
+        for (unsigned i=0; i + 1 < unit->mt_LinkCount; i++)
+        {
+            struct M68KUnitLink *link = &unit->mt_Links[i];
+
+            /* Site pointer of inline branch cache points to its first link. Forget cached targets */
+            if (*(uint64_t *)&link->ml_Slot[4] == (uintptr_t)link)
+            {
+                uint32_t offset = sl[i].sl_Offset;
+
+                sl[i].sl_M68kTarget = sl[i + 1].sl_M68kTarget = (uint32_t)(uintptr_t)BRANCH_CACHE_EMPTY;
+                code[offset + 2] = code[offset + 3] = (uint32_t)(uintptr_t)BRANCH_CACHE_EMPTY;
+                code[offset + 4] = code[offset + 5] = 0;
+                i++;
+            }
+        }
+
+        memcpy(&sl[unit->mt_LinkCount], unit->mt_Entries, unit->mt_EntryCount * sizeof(struct M68KSideEntry));
+        memcpy((struct M68KSideEntry *)&sl[unit->mt_LinkCount] + unit->mt_EntryCount, unit->mt_PCMap,
+               unit->mt_PCMapCount * sizeof(struct M68KPCMap));
+
+        su->su_Size = (sizeof(struct SnapshotUnit) + code_size + unit->mt_LinkCount * sizeof(struct SnapshotLink) +
+                       unit->mt_EntryCount * sizeof(struct M68KSideEntry) + unit->mt_PCMapCount * sizeof(struct M68KPCMap) + 7) & ~7;
+        ptr += su->su_Size;
+        count++;
+    }
+
+    header->sh_Magic = SNAPSHOT_MAGIC;
+    header->sh_Version = SNAPSHOT_VERSION;
+    header->sh_BuildID = Snapshot_BuildID();
+    header->sh_Control = __m68k_state->JIT_CONTROL;
+    header->sh_Control2 = __m68k_state->JIT_CONTROL2;
+    header->sh_UnitCount = count;
+
+    footer = (struct SnapshotFooter *)ptr;
+    footer->sf_Size = (uintptr_t)&footer[1] - (uintptr_t)header;
+    footer->sf_Magic = SNAPSHOT_MAGIC;
+
+    __m68k_state->JIT_SNAPSHOT_SIZE = footer->sf_Size;
+
+    kprintf("[ICache] Saved %d units into JIT snapshot at %08x, %d bytes\n", count, address, footer->sf_Size);
+
+    return footer->sf_Size;
+}
+
+/* Return size of the snapshot ending the image, 0 if there is none */
+uint32_t M68K_FindSnapshot(const void *image, uint32_t size)
+{
+    const struct SnapshotFooter *footer = (const struct SnapshotFooter *)((uintptr_t)image + size) - 1;
+
+    if (size < sizeof(struct SnapshotHeader) + sizeof(struct SnapshotFooter))
+        return 0;
+
+    if (footer->sf_Magic != SNAPSHOT_MAGIC || footer->sf_Size > size ||
+        footer->sf_Size < sizeof(struct SnapshotHeader) + sizeof(struct SnapshotFooter))
+        return 0;
+
+    if (((const struct SnapshotHeader *)((uintptr_t)image + size - footer->sf_Size))->sh_Magic != SNAPSHOT_MAGIC)
+        return 0;
+
+    return footer->sf_Size;
+}
+
+/* Put unit from the snapshot into the cache. Returns 0 if there is no more space */
+static int Snapshot_LoadUnit(const struct SnapshotUnit *su)
+{
+    struct M68KTranslationUnit *unit;
+    const uint32_t *code = (const uint32_t *)&su[1];
+    const struct SnapshotLink *sl = (const struct SnapshotLink *)((uintptr_t)code + su->su_CodeSize);
+    uint16_t *m68k_low = (uint16_t *)(uintptr_t)su->su_M68kLow;
+    uint16_t *m68k_high = (uint16_t *)(uintptr_t)su->su_M68kHigh;
+
+    if (!M68K_IsROM(su->su_M68kLow, su->su_M68kHigh) || (su->su_CodeSize & 7) != 0 ||
+        su->su_CodeSize > (JCCB_INSN_DEPTH_MASK + 1) * 16 * 64 || su->su_LinkCount > MAX_UNIT_LINKS ||
+        su->su_EntryCount > EMU68_UNIT_MAX_ENTRIES || su->su_Tier > 2 || sizeof(struct SnapshotUnit) + su->su_CodeSize +
+        su->su_LinkCount * sizeof(struct SnapshotLink) + su->su_EntryCount * sizeof(struct M68KSideEntry) +
+        su->su_PCMapCount * sizeof(struct M68KPCMap) > su->su_Size)
+        return 1;
+
+    for (unsigned i=0; i < su->su_LinkCount; i++)
+    {
+        /* Inline branch cache is followed by second slot, cached addresses and site pointer */
+        uint32_t words = sl[i].sl_M68kTarget == (uint32_t)(uintptr_t)BRANCH_CACHE_EMPTY ? 6 : 1;
+
+        if (sl[i].sl_Offset + words > su->su_CodeSize / 4)
+            return 1;
+        if (words != 1)
+            i++;
+    }
+
+    /* Code has changed since the snapshot was taken or it was translated already */
+    if (M68K_FindUnit((uint16_t *)(uintptr_t)su->su_M68kAddress) != NULL || CalcCRC32(m68k_low, m68k_high) != su->su_CRC32)
+        return 1;
+
+    if (unit_table_used >= EMU68_UNIT_TABLE_LIMIT - 1)
+        return 0;
+
+    uintptr_t links_offset = su->su_CodeSize;
+    uintptr_t pages_offset = links_offset + su->su_LinkCount * sizeof(struct M68KUnitLink);
+    uint32_t page_count = UnitPageCount(m68k_low, m68k_high);
+    uintptr_t entries_offset = pages_offset + page_count * sizeof(struct M68KUnitPage);
+    uintptr_t pc_map_offset = entries_offset + su->su_EntryCount * sizeof(struct M68KSideEntry);
+    uintptr_t unit_length = (pc_map_offset + su->su_PCMapCount * sizeof(struct M68KPCMap) + 63 + sizeof(struct M68KTranslationUnit)) & ~63;
+
+#if EMU68_JIT_ARENA
+    /* Never evict anything for the snapshot */
+    if (Arena_Size() - arena_used < 3 * ARENA_UNIT_MAX)
+        return 0;
+
+    unit = Arena_Reserve();
+    Arena_Commit(unit, unit_length);
+#else
+    unit = tlsf_malloc_aligned(jit_tlsf, unit_length, 64);
+    if (unit == NULL)
+        return 0;
+#endif
+    __m68k_state->JIT_CACHE_FREE = M68K_GetCacheFree();
+
+    unit->mt_ARMEntryPoint = (void *)((uintptr_t)&unit->mt_ARMCode[0] | 0x0000001000000000ULL);
+    unit->mt_M68kInsnCnt = su->su_M68kInsnCnt;
+    unit->mt_ARMInsnCnt = su->su_ARMInsnCnt;
+    unit->mt_UseCount = 0;
+    unit->mt_FetchCount = 0;
+    unit->mt_Referenced = 0;
+    unit->mt_Tier = su->su_Tier;
+    unit->mt_VerifySlot = 0;
+    unit->mt_M68kAddress = (uint16_t *)(uintptr_t)su->su_M68kAddress;
+    unit->mt_M68kLow = m68k_low;
+    unit->mt_M68kHigh = m68k_high;
+    unit->mt_CRC32 = su->su_CRC32;
+    unit->mt_PrologueSize = su->su_PrologueSize;
+    unit->mt_EpilogueSize = su->su_EpilogueSize;
+    unit->mt_Conditionals = su->su_Conditionals;
+    DuffCopy(&unit->mt_ARMCode[0], code, su->su_CodeSize / 4);
+
+    NEWLIST(&unit->mt_Incoming);
+    unit->mt_LinkCount = su->su_LinkCount;
+    unit->mt_Links = (struct M68KUnitLink *)((uintptr_t)&unit->mt_ARMCode[0] + links_offset);
+    unit->mt_PageCount = page_count;
+    unit->mt_Pages = (struct M68KUnitPage *)((uintptr_t)&unit->mt_ARMCode[0] + pages_offset);
+    unit->mt_EntryCount = su->su_EntryCount;
+    unit->mt_Entries = (struct M68KSideEntry *)((uintptr_t)&unit->mt_ARMCode[0] + entries_offset);
+    memcpy(unit->mt_Entries, &sl[su->su_LinkCount], su->su_EntryCount * sizeof(struct M68KSideEntry));
+    unit->mt_PCMapCount = su->su_PCMapCount;
+    unit->mt_PCMap = (struct M68KPCMap *)((uintptr_t)&unit->mt_ARMCode[0] + pc_map_offset);
+    memcpy(unit->mt_PCMap, (const struct M68KSideEntry *)&sl[su->su_LinkCount] + su->su_EntryCount,
+           su->su_PCMapCount * sizeof(struct M68KPCMap));
+
+    /* Exit counters of first tier code address the link records relative to the code, they need no fixup */
+    link_count = su->su_LinkCount;
+    for (unsigned i=0; i < link_count; i++)
+    {
+        link_offset[i] = sl[i].sl_Offset;
+        link_target[i] = (uint16_t *)(uintptr_t)sl[i].sl_M68kTarget;
+        link_source[i] = (uint16_t *)(uintptr_t)sl[i].sl_M68kSource;
+        link_counter[i] = 0;
+    }
+    M68K_SetupLinks(unit);
+
+    ADDHEAD(&LRU, &unit->mt_LRUNode);
+    M68K_InsertUnit(unit);
+    __m68k_state->JIT_UNIT_COUNT++;
+
+    arm_flush_cache((uintptr_t)&unit->mt_ARMCode, su->su_CodeSize);
+    arm_icache_invalidate((intptr_t)unit->mt_ARMEntryPoint, su->su_CodeSize);
+
+    M68K_LinkUnit(unit);
+
+    return 1;
+}
+
+/* Fill the cache with units from the snapshot, if it matches the running Emu68 and JIT settings */
+void M68K_LoadSnapshot(const void *snapshot, uint32_t size)
+{
+    const struct SnapshotHeader *header = snapshot;
+    uintptr_t ptr = (uintptr_t)&header[1];
+    uintptr_t end = (uintptr_t)snapshot + size - sizeof(struct SnapshotFooter);
+    uint32_t count = 0;
+
+    if (header->sh_Version != SNAPSHOT_VERSION || header->sh_BuildID != Snapshot_BuildID() ||
+        header->sh_Control != __m68k_state->JIT_CONTROL || header->sh_Control2 != __m68k_state->JIT_CONTROL2)
+    {
+        kprintf("[ICache] JIT snapshot does not match this build or JIT settings, ignored\n");
+        return;
+    }
+
+    for (uint32_t i=0; i < header->sh_UnitCount; i++)
+    {
+        const struct SnapshotUnit *su = (const struct SnapshotUnit *)ptr;
+
+        if (ptr + sizeof(struct SnapshotUnit) > end || su->su_Size < sizeof(struct SnapshotUnit) || ptr + su->su_Size > end)
+            break;
+
+        if (!Snapshot_LoadUnit(su))
+            break;
+
+        ptr += su->su_Size;
+        count++;
+    }
+
+    kprintf("[ICache] JIT snapshot: %d of %d units processed, %d units in cache\n", count, header->sh_UnitCount,
+        __m68k_state->JIT_UNIT_COUNT);
+}
+#endif
+
 void M68K_InitializeCache()
 {
     kprintf("[ICache] Initializing caches\n");
@@ -767,14 +3104,86 @@ void M68K_InitializeCache()
 
     kprintf("[ICache] Setting up ICache\n");
 
-    temporary_arm_code = tlsf_malloc(jit_tlsf, (JCCB_INSN_DEPTH_MASK + 1) * 16 * 64);
-    __m68k_state->JIT_CACHE_FREE = tlsf_get_free_size(jit_tlsf);
+    scratch_arm_code = tlsf_malloc(jit_tlsf, (JCCB_INSN_DEPTH_MASK + 1) * 16 * 64);
+    temporary_arm_code = scratch_arm_code;
     kprintf("[ICache] Temporary code at %p\n", temporary_arm_code);
+
+#if EMU68_JIT_ARENA
+    /* Take the JIT pool except of a reserve for TLSF into the arena */
+    uintptr_t pool_free = tlsf_get_free_size(jit_tlsf);
+    uintptr_t arena_size = pool_free > EMU68_JIT_ARENA_RESERVE ? (pool_free - EMU68_JIT_ARENA_RESERVE) & ~4095 : 0;
+    while (arena_size > 2 * ARENA_UNIT_MAX && (arena_base = (uintptr_t)tlsf_malloc_aligned(jit_tlsf, arena_size, 4096)) == 0)
+        arena_size = arena_size > 2 * ARENA_UNIT_MAX + 1024*1024 ? arena_size - 1024*1024 : 0;
+    if (arena_base == 0)
+    {
+        arena_end = 0;
+        kprintf("[ICache] Cannot allocate JIT arena, %d kB free in JIT pool\n", (int)(pool_free >> 10));
+
+        while(1);
+    }
+    arena_end = arena_base + arena_size;
+    arena_head = arena_tail = arena_base;
+    arena_used = 0;
+    kprintf("[ICache] JIT arena at %p, %d kB\n", (void*)arena_base, (int)(arena_size >> 10));
+#endif
     local_state = tlsf_malloc(tlsf, sizeof(struct M68KLocalState)*(JCCB_INSN_DEPTH_MASK + 1)*2);
-    kprintf("[ICache] ICache array at %p\n", ICache);
+    kprintf("[ICache] Unit table at %p\n", UnitTable);
+
+    UnitTable_Rebuild();
+
+    for (int i=0; i < EMU68_LINK_HASHSIZE; i++)
+        NEWLIST(&PendingLinks[i]);
+
+    for (int i=0; i < EMU68_PAGE_HASHSIZE; i++)
+        NEWLIST(&PageUnits[i]);
+    NEWLIST(&WideUnits);
+}
+
+/*
+    Find m68k PC of the instruction a host address belongs to, e.g. ELR of a fault taken in JIT code.
+    Returns 0 if the address is not within code of any unit or the unit has no PC map.
+*/
+uint32_t M68K_GetPCFromARM(uintptr_t arm_pc)
+{
+    struct Node *n;
+
+    /* Units are executed from read-only alias of JIT memory */
+    arm_pc &= ~0x0000001000000000ULL;
+
+    ForeachNode(&LRU, n)
+    {
+        struct M68KTranslationUnit *unit = (struct M68KTranslationUnit *)((uintptr_t)n - __builtin_offsetof(struct M68KTranslationUnit, mt_LRUNode));
+        uintptr_t code = (uintptr_t)&unit->mt_ARMCode[0];
+
+        if (arm_pc < code || arm_pc >= (uintptr_t)unit->mt_Links)
+            continue;
+
+        uint32_t offset = (arm_pc - code) >> 2;
+        int lo = 0, hi = (int)unit->mt_PCMapCount - 1, found = -1;
+
+        /* Last instruction starting at or before the offset */
+        while (lo <= hi)
+        {
+            int mid = (lo + hi) / 2;
+
+            if (unit->mt_PCMap[mid].pm_ARMOffset <= offset)
+            {
+                found = mid;
+                lo = mid + 1;
+            }
+            else
+                hi = mid - 1;
+        }
+
+        if (found < 0)
+            return unit->mt_PCMapCount ? (uint32_t)(uintptr_t)unit->mt_M68kAddress : 0;
+        if (unit->mt_PCMap[found].pm_M68kOffset == PCMAP_UNKNOWN)
+            return 0;
+
+        return (uint32_t)(uintptr_t)unit->mt_M68kAddress + unit->mt_PCMap[found].pm_M68kOffset;
+    }
 
-    for (int i=0; i < 65536; i++)
-        NEWLIST(&ICache[i]);
+    return 0;
 }
 
 void M68K_DumpStats()
@@ -0,0 +1,410 @@
+/*
+    Copyright © 2019 Michal Schulz <michal.schulz@gmx.de>
+    https://github.com/michalsc
+
+    This Source Code Form is subject to the terms of the
+    Mozilla Public License, v. 2.0. If a copy of the MPL was not distributed
+    with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "support.h"
+#include "RegisterAllocator.h"
+#include "A64.h"
+
+/*
+    Peephole optimizer working on the AArch64 code emitted for one m68k instruction.
+
+    The code is rewritten in place and compacted afterwards, therefore nothing may point into the
+    fragment. Fragments containing branches, PC relative loads or adr are left untouched - these
+    carry the exits of the unit, branch patch sites and inline data. The fragment starts at the
+    mls_ARMOffset of the instruction, which stays valid.
+
+    Registers are tracked conservatively: an instruction "mentions" a register if any of its
+    register fields (Rt/Rd, Rn, Rt2/Ra, Rm) holds the register number.
+*/
+
+#define PH_DELETED  0xffffffff
+
+static inline uint32_t PH_Get(uint32_t *code, int i)
+{
+    return INSN_TO_LE(code[i]);
+}
+
+static inline int PH_Deleted(uint32_t *code, int i)
+{
+    return code[i] == PH_DELETED;
+}
+
+static inline int PH_Mentions(uint32_t insn, uint8_t reg)
+{
+    return (insn & 31) == reg || ((insn >> 5) & 31) == reg ||
+           ((insn >> 10) & 31) == reg || ((insn >> 16) & 31) == reg;
+}
+
+static inline int PH_IsLoadStore(uint32_t insn)
+{
+    return (insn & 0x0a000000) == 0x08000000;
+}
+
+static inline int PH_IsSystem(uint32_t insn)
+{
+    return (insn & 0xffc00000) == 0xd5000000;
+}
+
+/* Branches, exception generating instructions and everything addressing relative to PC */
+static inline int PH_IsBarrier(uint32_t insn)
+{
+    if ((insn & 0x1c000000) == 0x14000000 && !PH_IsSystem(insn))
+        return 1;
+    if ((insn & 0x1f000000) == 0x10000000)     /* adr, adrp */
+        return 1;
+    if ((insn & 0x3b000000) == 0x18000000)     /* ldr literal, prfm literal */
+        return 1;
+    return 0;
+}
+
+static int PH_Next(uint32_t *code, int i, int count)
+{
+    for (++i; i < count; i++)
+        if (!PH_Deleted(code, i))
+            return i;
+
+    return count;
+}
+
+/* Index of next instruction after i mentioning reg, or count if there is none */
+static int PH_NextMention(uint32_t *code, int i, int count, uint8_t reg)
+{
+    for (i = PH_Next(code, i, count); i < count; i = PH_Next(code, i, count))
+        if (PH_Mentions(PH_Get(code, i), reg))
+            return i;
+
+    return count;
+}
+
+/* Temporary register not mentioned after instruction i and not kept allocated past the fragment */
+static int PH_DeadAfter(uint32_t *code, int i, int count, uint8_t reg, uint16_t live_temps)
+{
+    if (reg >= 12 || (live_temps & (1 << reg)))
+        return 0;
+
+    return PH_NextMention(code, i, count, reg) == count;
+}
+
+/* movz wT, #lo followed by movk wT, #0, lsl #16 or movk wT, #0xffff, lsl #16 */
+static int PH_ShortenConstants(uint32_t *code, int count)
+{
+    int changed = 0;
+
+    for (int i=0; i < count; i = PH_Next(code, i, count))
+    {
+        uint32_t insn = PH_Get(code, i);
+        int j = PH_Next(code, i, count);
+
+        if (PH_Deleted(code, i) || j >= count || (insn & 0xffe00000) != 0x52800000)
+            continue;
+
+        uint32_t next = PH_Get(code, j);
+
+        if ((next & 0xffe00000) != 0x72a00000 || (next & 31) != (insn & 31))
+            continue;
+
+        uint16_t hi = (next >> 5) & 0xffff;
+        uint16_t lo = (insn >> 5) & 0xffff;
+
+        if (hi == 0)
+        {
+            code[j] = PH_DELETED;
+            changed = 1;
+        }
+        else if (hi == 0xffff)
+        {
+            code[i] = movn_immed_u16(insn & 31, ~lo, 0);
+            code[j] = PH_DELETED;
+            changed = 1;
+        }
+    }
+
+    return changed;
+}
+
+/* Constant loaded to a temporary and used once by add/sub (or cmp/cmn) becomes its immediate */
+static int PH_FoldConstants(uint32_t *code, int count, uint16_t live_temps)
+{
+    int changed = 0;
+
+    for (int i=0; i < count; i = PH_Next(code, i, count))
+    {
+        uint32_t insn = PH_Get(code, i);
+        uint32_t value;
+        int last = i;
+
+        if (PH_Deleted(code, i))
+            continue;
+
+        if ((insn & 0xffe00000) == 0x52800000)
+            value = (insn >> 5) & 0xffff;
+        else if ((insn & 0xffe00000) == 0x12800000)
+            value = ~((insn >> 5) & 0xffff);
+        else
+            continue;
+
+        uint8_t reg = insn & 31;
+        int j = PH_Next(code, i, count);
+
+        if ((insn & 0xffe00000) == 0x52800000 && j < count &&
+            (PH_Get(code, j) & 0xffe0001f) == (0x72a00000 | reg))
+        {
+            value |= ((PH_Get(code, j) >> 5) & 0xffff) << 16;
+            last = j;
+        }
+
+        int use = PH_NextMention(code, last, count, reg);
+        if (use >= count)
+            continue;
+
+        uint32_t op = PH_Get(code, use);
+        uint8_t rd = op & 31;
+        uint8_t rn = (op >> 5) & 31;
+        uint8_t rm = (op >> 16) & 31;
+        int set_flags = (op >> 29) & 1;
+
+        /* 32-bit add/sub (shifted register) with unshifted Rm */
+        if ((op & 0x9fe0fc00) != 0x0b000000 || rm != reg || rn == reg || rn == 31 ||
+            (!set_flags && rd == 31) || !PH_DeadAfter(code, use, count, reg, live_temps))
+            continue;
+
+        uint32_t imm;
+
+        if (value < 0x1000)
+            imm = value << 10;
+        else if ((value & 0xfff) == 0 && value < 0x1000000)
+            imm = (1 << 22) | (value >> 2);
+        else if (!set_flags && (-value) < 0x1000)
+        {
+            imm = (-value) << 10;
+            op ^= 0x40000000;
+        }
+        else
+            continue;
+
+        code[use] = I32(0x11000000 | (op & 0x60000000) | imm | (rn << 5) | rd);
+        code[i] = PH_DELETED;
+        if (last != i)
+            code[last] = PH_DELETED;
+        changed = 1;
+    }
+
+    return changed;
+}
+
+/*
+    mov wT, wS followed by a 32-bit data processing instruction reading wT. The instruction reads
+    wS instead and the copy is removed. Covers the temporaries made by RA_CopyFromM68kRegister.
+*/
+static int PH_PropagateCopies(uint32_t *code, int count, uint16_t live_temps)
+{
+    int changed = 0;
+
+    for (int i=0; i < count; i = PH_Next(code, i, count))
+    {
+        uint32_t insn = PH_Get(code, i);
+
+        if (PH_Deleted(code, i) || (insn & 0xffe0ffe0) != 0x2a0003e0)
+            continue;
+
+        uint8_t tmp = insn & 31;
+        uint8_t src = (insn >> 16) & 31;
+
+        if (tmp == src || src == 31)
+            continue;
+
+        int use = PH_NextMention(code, i, count, tmp);
+        if (use >= count || PH_NextMention(code, i, count, src) < use)
+            continue;
+
+        uint32_t op = PH_Get(code, use);
+
+        /* 32-bit logical or add/sub with register operands, tmp read only */
+        if ((op & 0x9f000000) != 0x0a000000 && (op & 0x9f000000) != 0x0b000000)
+            continue;
+        if ((op & 31) == tmp || ((op >> 10) & 31) == tmp)
+            continue;
+        if (!PH_DeadAfter(code, use, count, tmp, live_temps))
+            continue;
+
+        if (((op >> 5) & 31) == tmp)
+            op = (op & ~(31 << 5)) | (src << 5);
+        if (((op >> 16) & 31) == tmp)
+            op = (op & ~(31 << 16)) | (src << 16);
+
+        code[use] = I32(op);
+        code[i] = PH_DELETED;
+        changed = 1;
+    }
+
+    return changed;
+}
+
+/* Adjacent ldr/str at consecutive offsets from the context pointer become ldp/stp */
+static int PH_PairContextAccess(uint32_t *code, int count, uint8_t ctx)
+{
+    const uint32_t mrs_ctx = INSN_TO_LE(mrs(0, 3, 3, 13, 0, 3));
+    int changed = 0;
+
+    for (int i=0; i < count; i = PH_Next(code, i, count))
+    {
+        uint32_t insn = PH_Get(code, i);
+
+        if (PH_Deleted(code, i))
+            continue;
+
+        if ((insn & ~31) == mrs_ctx)
+        {
+            ctx = insn & 31;
+            continue;
+        }
+
+        if (ctx == 0xff)
+            continue;
+
+        uint32_t kind = insn & 0xffc00000;
+        int j = PH_Next(code, i, count);
+        uint32_t next = j < count ? PH_Get(code, j) : 0;
+
+        if ((kind == 0xb9400000 || kind == 0xb9000000 || kind == 0xf9400000 || kind == 0xf9000000) &&
+            j < count && (next & 0xffc00000) == kind &&
+            ((insn >> 5) & 31) == ctx && ((next >> 5) & 31) == ctx)
+        {
+            int size = (kind & 0x40000000) ? 8 : 4;
+            int load = (kind & 0x00400000) != 0;
+            uint32_t off1 = ((insn >> 10) & 0xfff) * size;
+            uint32_t off2 = ((next >> 10) & 0xfff) * size;
+            uint8_t rt1 = insn & 31;
+            uint8_t rt2 = next & 31;
+
+            if (load && (rt1 == rt2 || rt1 == ctx || rt2 == ctx))
+                goto track;
+
+            if (off1 + size == off2 && off1 <= 63u * size)
+            {
+                if (size == 8)
+                    code[i] = load ? ldp64(ctx, rt1, rt2, off1) : stp64(ctx, rt1, rt2, off1);
+                else
+                    code[i] = load ? ldp(ctx, rt1, rt2, off1) : stp(ctx, rt1, rt2, off1);
+                code[j] = PH_DELETED;
+                changed = 1;
+                continue;
+            }
+            else if (off2 + size == off1 && off2 <= 63u * size)
+            {
+                if (size == 8)
+                    code[i] = load ? ldp64(ctx, rt2, rt1, off2) : stp64(ctx, rt2, rt1, off2);
+                else
+                    code[i] = load ? ldp(ctx, rt2, rt1, off2) : stp(ctx, rt2, rt1, off2);
+                code[j] = PH_DELETED;
+                changed = 1;
+                continue;
+            }
+        }
+
+track:
+        /* Context register overwritten or modified by a writeback */
+        if ((insn & 31) == ctx)
+            ctx = 0xff;
+        else if (PH_IsLoadStore(insn))
+        {
+            if ((insn & 0x3a400000) == 0x28400000 && ((insn >> 10) & 31) == ctx)
+                ctx = 0xff;
+            else if (((insn >> 5) & 31) == ctx && (insn & 0x3b000000) != 0x39000000 &&
+                     (insn & 0x3b800000) != 0x29000000)
+                ctx = 0xff;
+        }
+    }
+
+    return changed;
+}
+
+/* add/sub of REG_PC separated only by code not touching REG_PC nor memory are merged */
+static int PH_MergePCUpdates(uint32_t *code, int count)
+{
+    int changed = 0;
+
+    for (int i=0; i < count; i = PH_Next(code, i, count))
+    {
+        uint32_t insn = PH_Get(code, i);
+
+        if (PH_Deleted(code, i) || (insn & 0xbfc003ff) != (0x11000000 | (REG_PC << 5) | REG_PC))
+            continue;
+
+        int j;
+        for (j = PH_Next(code, i, count); j < count; j = PH_Next(code, j, count))
+        {
+            uint32_t op = PH_Get(code, j);
+
+            if (PH_Mentions(op, REG_PC) || PH_IsLoadStore(op) || PH_IsSystem(op))
+                break;
+        }
+
+        if (j >= count)
+            continue;
+
+        uint32_t next = PH_Get(code, j);
+
+        if ((next & 0xbfc003ff) != (0x11000000 | (REG_PC << 5) | REG_PC))
+            continue;
+
+        int32_t sum = (insn & 0x40000000) ? -(int32_t)((insn >> 10) & 0xfff) : (int32_t)((insn >> 10) & 0xfff);
+        sum += (next & 0x40000000) ? -(int32_t)((next >> 10) & 0xfff) : (int32_t)((next >> 10) & 0xfff);
+
+        if (sum >= 0x1000 || sum <= -0x1000)
+            continue;
+
+        if (sum > 0)
+            code[i] = add_immed(REG_PC, REG_PC, sum);
+        else if (sum < 0)
+            code[i] = sub_immed(REG_PC, REG_PC, -sum);
+        else
+            code[i] = PH_DELETED;
+        code[j] = PH_DELETED;
+        changed = 1;
+    }
+
+    return changed;
+}
+
+/*
+    Optimize AArch64 code of one m68k instruction between start and end. live_temps is the mask of
+    temporary registers still allocated after the instruction, ctx the register holding context
+    pointer on entry (or 0xff). Returns new end of the code.
+*/
+uint32_t *A64_Peephole(uint32_t *start, uint32_t *end, uint16_t live_temps, uint8_t ctx)
+{
+    int count = end - start;
+    int changed;
+    int pass = 0;
+    uint32_t *out = start;
+
+    for (int i=0; i < count; i++)
+    {
+        if (PH_IsBarrier(PH_Get(start, i)) || start[i] == PH_DELETED)
+            return end;
+    }
+
+    do
+    {
+        changed = PH_ShortenConstants(start, count);
+        changed |= PH_FoldConstants(start, count, live_temps);
+        changed |= PH_PropagateCopies(start, count, live_temps);
+        changed |= PH_PairContextAccess(start, count, ctx);
+        changed |= PH_MergePCUpdates(start, count);
+    } while (changed && ++pass < 4);
+
+    for (int i=0; i < count; i++)
+    {
+        if (start[i] != PH_DELETED)
+            *out++ = start[i];
+    }
+
+    return out;
+}
@@ -340,6 +340,117 @@ void RA_FlushCC(uint32_t **ptr)
     mod_CC = 0;
 }
 
+/*
+    Lazy condition codes. If the instruction being translated is followed by a Bcc, the translator
+    announces the condition of that Bcc and the flags needed past it. A compare or test may then
+    leave the flags consumed by the Bcc alone in host NZCV. The Bcc branches on host condition
+    directly and the flags are never materialized in the CC register.
+*/
+static uint8_t lazy_CC_cond = 0xff;
+static uint8_t lazy_CC_after = 0;
+static uint8_t lazy_CC_kind = 0;
+static uint8_t lazy_CC_mask = 0;
+
+static uint8_t RA_LazyCondition(uint8_t kind, uint8_t m68k_condition)
+{
+    switch (m68k_condition)
+    {
+        case M_CC_EQ:   return A64_CC_EQ;
+        case M_CC_NE:   return A64_CC_NE;
+        case M_CC_MI:   return A64_CC_MI;
+        case M_CC_PL:   return A64_CC_PL;
+        case M_CC_VS:   return A64_CC_VS;
+        case M_CC_VC:   return A64_CC_VC;
+        case M_CC_GE:   return A64_CC_GE;
+        case M_CC_LT:   return A64_CC_LT;
+        case M_CC_GT:   return A64_CC_GT;
+        case M_CC_LE:   return A64_CC_LE;
+        /* Host C is inverted after subtraction. After test it is clear, as is the m68k one */
+        case M_CC_CS:   return kind == LAZY_CC_NZnCV ? A64_CC_CC : A64_CC_CS;
+        case M_CC_CC:   return kind == LAZY_CC_NZnCV ? A64_CC_CS : A64_CC_CC;
+        case M_CC_HI:   return kind == LAZY_CC_NZnCV ? A64_CC_HI : A64_CC_NE;
+        case M_CC_LS:   return kind == LAZY_CC_NZnCV ? A64_CC_LS : A64_CC_EQ;
+        default:        return 0xff;
+    }
+}
+
+void RA_AllowLazyCC(uint8_t m68k_condition, uint8_t after_mask)
+{
+    lazy_CC_cond = m68k_condition;
+    lazy_CC_after = after_mask;
+}
+
+/*
+    Called by the emitter right after the host instruction which set NZCV. Returns the subset
+    of update_mask which has to be materialized in the CC register now.
+*/
+uint8_t RA_DeferCC(uint8_t kind, uint8_t update_mask)
+{
+    if (lazy_CC_cond == 0xff || update_mask == 0 || (update_mask & SR_X))
+        return update_mask;
+
+    if (RA_LazyCondition(kind, lazy_CC_cond) == 0xff)
+        return update_mask;
+
+    lazy_CC_kind = kind;
+    lazy_CC_mask = update_mask;
+    lazy_CC_cond = 0xff;
+
+    return update_mask & lazy_CC_after;
+}
+
+/* Materialize flags still pending in host NZCV into the CC register */
+void RA_ResolveLazyCC(uint32_t **ptr)
+{
+    lazy_CC_cond = 0xff;
+
+    if (lazy_CC_kind == 0)
+        return;
+
+    uint8_t cc = RA_ModifyCC(ptr);
+    uint8_t mask = lazy_CC_mask;
+
+    if (lazy_CC_kind == LAZY_CC_NZnCV)
+        *ptr = EMIT_GetNZnCV(*ptr, cc, &mask);
+    else
+        *ptr = EMIT_GetNZ00(*ptr, cc, &mask);
+
+    lazy_CC_kind = 0;
+    lazy_CC_mask = 0;
+}
+
+/*
+    Returns the host condition equivalent to the m68k condition if the flags are pending in
+    NZCV, 0xff otherwise. Pending flags are consumed by the call.
+*/
+uint8_t RA_ConsumeLazyCC(uint32_t **ptr, uint8_t m68k_condition)
+{
+    uint8_t host_condition;
+
+    if (lazy_CC_kind == 0)
+        return 0xff;
+
+    host_condition = RA_LazyCondition(lazy_CC_kind, m68k_condition);
+
+    if (host_condition == 0xff)
+    {
+        RA_ResolveLazyCC(ptr);
+    }
+    else
+    {
+        lazy_CC_kind = 0;
+        lazy_CC_mask = 0;
+    }
+
+    return host_condition;
+}
+
+/* Returns non-zero if flags are pending in host NZCV */
+int RA_IsLazyCC()
+{
+    return (lazy_CC_kind != 0);
+}
+
 int RA_IsCCLoaded()
 {
     return (reg_CC != 0xff);
@@ -548,6 +548,103 @@ void mmu_map(uintptr_t phys, uintptr_t virt, uintptr_t length, uint32_t attr_low
 "       isb                         \n");
 }
 
+/* Return pointer to the descriptor mapping the address in bottom half and its level, NULL if not mapped */
+static uint64_t *mmu_find_entry(uintptr_t virt, int *level)
+{
+    uint64_t *tbl;
+    uint64_t tmp;
+
+    asm volatile("mrs %0, TTBR0_EL1":"=r"(tbl));
+    tbl = (uint64_t *)((uintptr_t)tbl + PHYS_VIRT_OFFSET);
+
+    tmp = tbl[(virt >> 30) & 0x1ff];
+    if ((tmp & 3) == 1)
+    {
+        *level = 1;
+        return &tbl[(virt >> 30) & 0x1ff];
+    }
+    else if ((tmp & 3) == 0)
+        return NULL;
+
+    tbl = (uint64_t *)((tmp & 0x0000fffffffff000) + PHYS_VIRT_OFFSET);
+    tmp = tbl[(virt >> 21) & 0x1ff];
+    if ((tmp & 3) == 1)
+    {
+        *level = 2;
+        return &tbl[(virt >> 21) & 0x1ff];
+    }
+    else if ((tmp & 3) == 0)
+        return NULL;
+
+    tbl = (uint64_t *)((tmp & 0x0000fffffffff000) + PHYS_VIRT_OFFSET);
+    tmp = tbl[(virt >> 12) & 0x1ff];
+    if ((tmp & 3) != 3)
+        return NULL;
+
+    *level = 3;
+    return &tbl[(virt >> 12) & 0x1ff];
+}
+
+/* Map the range with 4K pages only, so that permissions of single pages can be changed later */
+void mmu_map_4k(uintptr_t phys, uintptr_t virt, uintptr_t length, uint32_t attr_low, uint32_t attr_high)
+{
+    DMAP(kprintf("mmu_map_4k(%p, %p, %x, %04x00000000%04x)\n", phys, virt, length, attr_high, attr_low));
+
+    while (length >= 4096)
+    {
+        put_4k_page(phys, virt, attr_low, attr_high);
+        phys += 4096;
+        virt += 4096;
+        length -= 4096;
+    }
+
+        asm volatile(
+"       dsb     ish                 \n"
+"       tlbi    VMALLE1IS           \n" /* Flush tlb */
+"       dsb     sy                  \n"
+"       isb                         \n");
+}
+
+/*
+    Make 4K page of bottom half read-only or writable again. Only pages mapped as writable cached
+    memory with 4K pages (see mmu_map_4k) are protected. Blocks are not split here, replacing a live
+    block with a table would require break-before-make while other cores may access the range.
+    Changing permissions of a page entry does not. Returns 1 if the permissions were changed, 0
+    otherwise.
+*/
+int mmu_protect_page(uintptr_t virt, int protect)
+{
+    int level = 0;
+    uint64_t *entry;
+    uint64_t desc;
+
+    virt &= ~4095ULL;
+    entry = mmu_find_entry(virt, &level);
+
+    if (entry == NULL || level != 3)
+        return 0;
+
+    desc = *entry;
+
+    if (protect && ((desc & MMU_READ_ONLY) || (desc & MMU_ATTR(7)) != MMU_ATTR_CACHED))
+        return 0;
+    if (!protect && !(desc & MMU_READ_ONLY))
+        return 0;
+
+    if (protect)
+        *entry |= MMU_READ_ONLY;
+    else
+        *entry &= ~(uint64_t)MMU_READ_ONLY;
+
+    asm volatile(
+"       dsb     ish                 \n"
+"       tlbi    VMALLE1IS           \n" /* Flush tlb */
+"       dsb     sy                  \n"
+"       isb                         \n");
+
+    return 1;
+}
+
 void mmu_unmap(uintptr_t virt, uintptr_t length)
 {
     (void)virt;
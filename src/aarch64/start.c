@@ -302,9 +302,16 @@ void __vectors_start(void);
 extern int debug_cnt;
 int enable_cache = 0;
 int limit_2g = 0;
+uint32_t jit_grow_pages = 0;
 int zorro_disable = 0;
 int chip_slowdown;
 int dbf_slowdown;
+int smc_protect;
+int warm_reset;
+#if EMU68_JIT_SNAPSHOT
+static void *jit_snapshot;
+static uint32_t jit_snapshot_size;
+#endif
 int emu68_icnt = EMU68_M68K_INSN_DEPTH;
 int emu68_ccrd = EMU68_CCR_SCAN_DEPTH;
 int emu68_irng = EMU68_BRANCH_INLINE_DISTANCE;
@@ -449,6 +456,10 @@ void secondary_boot(void)
     {
         if (async_log)
             serial_writer();
+#if EMU68_BACKGROUND_VERIFY
+        else
+            M68K_VerifyWorker();
+#endif
     }
     else if (cpu_id == 2)
     {
@@ -461,6 +472,10 @@ void secondary_boot(void)
     }
 #else
     (void)async_log;
+#if EMU68_BACKGROUND_VERIFY
+    if (cpu_id == 1)
+        M68K_VerifyWorker();
+#endif
 #endif
 
     while(1) { asm volatile("wfe"); }
@@ -566,14 +581,35 @@ void boot(void *dtree)
         of_property_t * prop = dt_find_property(e, "bootargs");
         if (prop)
         {
-#ifdef PISTORM
             const char *tok;
-#endif
 
             if (find_token(prop->op_value, "enable_cache"))
                 enable_cache = 1;
             if (find_token(prop->op_value, "limit_2g"))
                 limit_2g = 1;
+
+            /* Largest size of JIT pool in MB, memory above the default size is reserved for it */
+            if ((tok = find_token(prop->op_value, "jit_max=")))
+            {
+                uint32_t val = 0;
+                const char *c = &tok[8];
+
+                for (int i=0; i < 5; i++)
+                {
+                    if (c[i] < '0' || c[i] > '9')
+                        break;
+
+                    val = val * 10 + c[i] - '0';
+                }
+
+                val /= 2;
+
+                if (val > KERNEL_JIT_PAGES)
+                    jit_grow_pages = val - KERNEL_JIT_PAGES;
+
+                if (jit_grow_pages > KERNEL_JIT_MAX_PAGES)
+                    jit_grow_pages = KERNEL_JIT_MAX_PAGES;
+            }
 #ifdef PISTORM
 #ifdef PISTORM32LITE
             if (find_token(prop->op_value, "two_slot"))
@@ -652,6 +688,10 @@ void boot(void *dtree)
                 dbf_slowdown = 0;
             }
 
+            smc_protect = !(!find_token(prop->op_value, "smc_protect") && !find_token(prop->op_value, "SMC"));
+
+            warm_reset = !!find_token(prop->op_value, "warm_reset");
+
             blitwait = !(!find_token(prop->op_value, "blitwait") && !find_token(prop->op_value, "BW"));
 
             if ((tok = find_token(prop->op_value, "ICNT=")))
@@ -919,6 +959,17 @@ void boot(void *dtree)
 #endif
     }
 
+#if EMU68_JIT_SNAPSHOT
+    /* Snapshot of translated ROM code may be appended to the image. Keep it until the JIT is up */
+    if (initramfs_size != 0 && (jit_snapshot_size = M68K_FindSnapshot(initramfs_loc, initramfs_size)) != 0)
+    {
+        initramfs_size -= jit_snapshot_size;
+        jit_snapshot = tlsf_malloc(tlsf, jit_snapshot_size);
+        memcpy(jit_snapshot, (void*)((uintptr_t)initramfs_loc + initramfs_size), jit_snapshot_size);
+        kprintf("[BOOT] JIT snapshot found, %d bytes\n", jit_snapshot_size);
+    }
+#endif
+
 #ifdef PISTORM32LITE
     ps_efinix_setup();
     ps_efinix_load(firmware_file, firmware_size);
@@ -981,6 +1032,12 @@ void boot(void *dtree)
 
         sys_memory[block_top].mb_Size -= (KERNEL_RSRVD_PAGES << 21);
 
+        /* Reserve for growing JIT pool is taken right below the kernel, leave at least half of the block */
+        if ((uintptr_t)jit_grow_pages << 21 > sys_memory[block_top].mb_Size / 2)
+            jit_grow_pages = (sys_memory[block_top].mb_Size / 2) >> 21;
+
+        sys_memory[block_top].mb_Size -= (uintptr_t)jit_grow_pages << 21;
+
         range = p->op_value;
         top_of_ram = 0;
         for (int block=0; block < block_count; block++)
@@ -1019,8 +1076,13 @@ void boot(void *dtree)
                     }
                 }
 
-                mmu_map(sys_memory[block].mb_Base, sys_memory[block].mb_Base, size,
-                        MMU_ACCESS | MMU_ISHARE | MMU_ATTR_CACHED, 0);
+                /* Pages holding translated code are write protected one by one with smc_protect */
+                if (smc_protect)
+                    mmu_map_4k(sys_memory[block].mb_Base, sys_memory[block].mb_Base, size,
+                            MMU_ACCESS | MMU_ISHARE | MMU_ATTR_CACHED, 0);
+                else
+                    mmu_map(sys_memory[block].mb_Base, sys_memory[block].mb_Base, size,
+                            MMU_ACCESS | MMU_ISHARE | MMU_ATTR_CACHED, 0);
 
                 if (sys_memory[block].mb_Base + size > top_of_ram)
                 {
@@ -1043,10 +1105,25 @@ void boot(void *dtree)
 
         jit_tlsf = tlsf_init_with_memory((void*)0xffffffe000000000, KERNEL_JIT_PAGES << 21);
 
+        /* Reserve follows the JIT pool in both views, it is added to the pool in 2MB pages when needed */
+        if (jit_grow_pages)
+        {
+            mmu_map(kernel_new_loc - ((uintptr_t)jit_grow_pages << 21), 0xffffffe000000000 + (KERNEL_JIT_PAGES << 21),
+                    (uintptr_t)jit_grow_pages << 21, MMU_ACCESS | MMU_ISHARE | MMU_ATTR_CACHED, 0);
+            mmu_map(kernel_new_loc - ((uintptr_t)jit_grow_pages << 21), 0xfffffff000000000 + (KERNEL_JIT_PAGES << 21),
+                    (uintptr_t)jit_grow_pages << 21, MMU_ACCESS | MMU_ISHARE | MMU_ALLOW_EL0 | MMU_READ_ONLY | MMU_ATTR_CACHED, 0);
+
+            jit_reserve = 0xffffffe000000000 + (KERNEL_JIT_PAGES << 21);
+            jit_reserve_size = (uintptr_t)jit_grow_pages << 21;
+        }
+
         kprintf("[BOOT] Local memory pools:\n");
         kprintf("[BOOT]    SYS: %p - %p (size: %5d KiB)\n", &__bootstrap_end, kernel_top_virt - 1, pool_size / 1024);
         kprintf("[BOOT]    JIT: %p - %p (size: %5d KiB)\n", 0xffffffe000000000,
                     0xffffffe000000000 + (KERNEL_JIT_PAGES << 21) - 1, KERNEL_JIT_PAGES << 11);
+        if (jit_reserve_size)
+            kprintf("[BOOT]    JIT reserve: %p - %p (size: %5d KiB)\n", jit_reserve,
+                    jit_reserve + jit_reserve_size - 1, jit_reserve_size >> 10);
 
         kprintf("[BOOT] Moving kernel from %p to %p\n", (void*)kernel_old_loc, (void*)kernel_new_loc);
         kprintf("[BOOT] Top of RAM (32bit): %08x\n", top_of_ram);
@@ -1691,31 +1768,30 @@ void  __attribute__((used)) stub_FindUnit()
     asm volatile(
 "       .align  8                           \n"
 "FindUnit:                                  \n"
-"       adrp    x4, ICache                  \n"
-"       add     x4, x4, :lo12:ICache        \n"
-"       and     x0, x%[reg_pc], 0x1fffe0    \n" // Hash is (address >> 5) & 0xffff !!!!
-"       ldr     x0, [x4, x0]                \n"
-"       b       1f                          \n"
-"3:                                         \n" // 2 -> 5
-"       cmp     w5, w%[reg_pc]              \n"
+"       adrp    x4, UnitTable               \n"
+"       add     x4, x4, :lo12:UnitTable     \n"
+"       lsl     w5, w%[reg_pc], #2          \n" // First slot of the line selected by (address >> 4)
+"       and     x5, x5, #%[line_mask]       \n"
+"1:     add     x6, x4, x5                  \n"
+"       ldr     w7, [x6, #%[slot_pc]]       \n"
+"       cmp     w7, w%[reg_pc]              \n"
 "       b.eq    2f                          \n"
-"       mov     x0, x4                      \n"
-"1:     ldr     x4, [x0]                    \n"
-"       ldr     x5, [x0, #32]               \n"
-"       cbnz    x4, 3b                      \n"
-"       mov     x0, #0                      \n"
-"4:     ret                                 \n"
-"2:     ldp     x6, x4, [x0, #16]           \n"
-"       ldr     x5, [x4, #8]                \n"
-"       cbz     x5, 4b                      \n"
-"       stp     x4, x5, [x0, #16]           \n"
-"       add     x7, x0, #0x10               \n" // 4 -> 7
-"       str     x7, [x5]                    \n"
-"       stp     x6, x7, [x4]                \n"
-"       str     x4, [x6, #8]                \n"
+"       cmn     w7, #1                      \n" // Empty slot ends the search
+"       b.eq    3f                          \n"
+"       add     x5, x5, #%[slot_size]       \n"
+"       and     x5, x5, #%[table_mask]      \n"
+"       b       1b                          \n"
+"2:     ldr     x0, [x6, #%[slot_unit]]     \n"
+"       ret                                 \n"
+"3:     mov     x0, #0                      \n"
 "       ret                                 \n"
 
-::[reg_pc]"i"(REG_PC));
+::[reg_pc]"i"(REG_PC),
+  [line_mask]"i"(EMU68_UNIT_TABLE_LINE_MASK),
+  [table_mask]"i"(EMU68_UNIT_TABLE_MASK),
+  [slot_size]"i"(sizeof(struct M68KUnitSlot)),
+  [slot_pc]"i"(__builtin_offsetof(struct M68KUnitSlot, us_M68kAddress)),
+  [slot_unit]"i"(__builtin_offsetof(struct M68KUnitSlot, us_Unit)));
 }
 
 #ifdef PISTORM
@@ -1772,30 +1848,26 @@ void  __attribute__((used)) stub_ExecutionLoop()
 "       b       1b                          \n"
 "       .align  6                           \n"
 "13:                                        \n"
-"       and     x0, x%[reg_pc], 0x1fffe0    \n" // Hash is (address >> 5) & 0xffff !!!!
-"       adrp    x4, ICache                  \n"
-"       add     x4, x4, :lo12:ICache        \n"
-"       ldr     x0, [x4, x0]                \n"
-"       b       51f                         \n"
-"53:                                        \n" // 2 -> 5
+"       lsl     w0, w%[reg_pc], #2          \n" // First slot of the line selected by (address >> 4)
+"       and     x0, x0, #%[line_mask]       \n"
+"       adrp    x4, UnitTable               \n"
+"       add     x4, x4, :lo12:UnitTable     \n"
+"51:    add     x6, x4, x0                  \n"
+"       ldr     w5, [x6, #%[slot_pc]]       \n"
 "       cmp     w5, w%[reg_pc]              \n"
 "       b.eq    52f                         \n"
-"       mov     x0, x4                      \n"
-"51:    ldr     x4, [x0]                    \n"
-"       ldr     x5, [x0, #32]               \n" // Fetch PC address now, we assume that the search was successful
-"       cbnz    x4, 53b                     \n"
-"       b 5f                                \n"
-"52:    ldp     x6, x4, [x0, #16]           \n"
-"       ldr     x5, [x4, #8]                \n"
-"       cbz     x5, 55f                     \n"
-"       stp     x4, x5, [x0, #16]           \n"
-"       add     x7, x0, #0x10               \n" // 4 -> 7
-"       str     x7, [x5]                    \n"
-"       stp     x6, x7, [x4]                \n"
-"       str     x4, [x6, #8]                \n"
-
-"55:                                        \n"
+"       cmn     w5, #1                      \n" // Empty slot, unit not in the table
+"       b.eq    5f                          \n"
+"       add     x0, x0, #%[slot_size]       \n"
+"       and     x0, x0, #%[table_mask]      \n"
+"       b       51b                         \n"
+"52:    ldr     x0, [x6, #%[slot_unit]]     \n"
 "       ldr     x12, [x0, #%[offset]]       \n"
+"       ldrb    w1, [x0, #%[ref]]           \n" // Set reference bit for eviction clock,
+"       cbnz    w1, 53f                     \n" // store only if it was cleared
+"       mov     w1, #1                      \n"
+"       strb    w1, [x0, #%[ref]]           \n"
+"53:                                        \n"
 #if EMU68_LOG_FETCHES
 "       ldr     x1, [x0, #%[fcount]]        \n"
 "       add     x1, x1, #1                  \n"
@@ -2033,6 +2105,7 @@ void  __attribute__((used)) stub_ExecutionLoop()
  [sr_s]"i"(SR_S),
  [sr_t01]"i"(SR_T0 | SR_T1),
  [fcount]"i"(__builtin_offsetof(struct M68KTranslationUnit, mt_FetchCount)),
+ [ref]"i"(__builtin_offsetof(struct M68KTranslationUnit, mt_Referenced)),
  [cacr]"i"(__builtin_offsetof(struct M68KState, CACR)),
  [offset]"i"(__builtin_offsetof(struct M68KTranslationUnit, mt_ARMEntryPoint)),
  [diff]"i"(__builtin_offsetof(struct M68KTranslationUnit, mt_ARMCode) - 
@@ -2045,7 +2118,12 @@ void  __attribute__((used)) stub_ExecutionLoop()
  [usp]"i"(__builtin_offsetof(struct M68KState, USP)),
  [isp]"i"(__builtin_offsetof(struct M68KState, ISP)),
  [msp]"i"(__builtin_offsetof(struct M68KState, MSP)),
- [vbr]"i"(__builtin_offsetof(struct M68KState, VBR))
+ [vbr]"i"(__builtin_offsetof(struct M68KState, VBR)),
+ [line_mask]"i"(EMU68_UNIT_TABLE_LINE_MASK),
+ [table_mask]"i"(EMU68_UNIT_TABLE_MASK),
+ [slot_size]"i"(sizeof(struct M68KUnitSlot)),
+ [slot_pc]"i"(__builtin_offsetof(struct M68KUnitSlot, us_M68kAddress)),
+ [slot_unit]"i"(__builtin_offsetof(struct M68KUnitSlot, us_Unit))
     );
 
 
@@ -2054,6 +2132,44 @@ void  __attribute__((used)) stub_ExecutionLoop()
 struct M68KState *__m68k_state;
 void MainLoop();
 
+#if defined(PISTORM) && EMU68_WARM_RESET
+/*
+    Called from the main loop once the housekeeper has seen reset of the Amiga. Waits until the reset
+    is released, then restarts m68k from the reset vector as M68K_StartEmu does, but without reboot
+    of the RasPi. Translated ROM code stays in the JIT cache, see M68K_ResetCache.
+*/
+void M68K_WarmReset(struct M68KState *ctx)
+{
+    void do_reset();
+    uint32_t *addr;
+
+    M68K_ResetCache();
+
+    while (__atomic_load_n(&ctx->INT.RESET, __ATOMIC_ACQUIRE) == 1)
+        asm volatile("wfe");
+
+    do_reset();
+
+    /* Overlay is active again after reset */
+    if (fast_page0) {
+        mmu_map(0xf80000, 0x0, 4096, MMU_ACCESS | MMU_ISHARE | MMU_ALLOW_EL0 | MMU_READ_ONLY | MMU_ATTR_CACHED, 0);
+    }
+
+    asm volatile("mov %0, #0":"=r"(addr));
+
+    ctx->ISP.u32 = BE32(*addr);
+    ctx->PC = BE32(*(addr+1));
+    ctx->SR = BE16(SR_S | SR_IPL);
+    ctx->VBR = 0;
+    ctx->CACR = 0;
+    ctx->FPCR = 0;
+
+    kprintf("[JIT] Warm reset, m68k restarts at %08x\n", BE32(ctx->PC));
+
+    __atomic_store_n(&ctx->INT.RESET, 0, __ATOMIC_RELEASE);
+}
+#endif
+
 void M68K_StartEmu(void *addr, void *fdt)
 {
     void (*arm_code)();
@@ -2088,7 +2204,7 @@ void M68K_StartEmu(void *addr, void *fdt)
     __m68k.SR = BE16(SR_S | SR_IPL);
     __m68k.FPCR = 0;
     __m68k.JIT_CACHE_TOTAL = tlsf_get_total_size(jit_tlsf);
-    __m68k.JIT_CACHE_FREE = tlsf_get_free_size(jit_tlsf);
+    __m68k.JIT_CACHE_FREE = M68K_GetCacheFree();
     __m68k.JIT_UNIT_COUNT = 0;
     __m68k.JIT_SOFTFLUSH_THRESH = EMU68_WEAK_CFLUSH_LIMIT;
     __m68k.JIT_CONTROL = EMU68_WEAK_CFLUSH ? JCCF_SOFT : 0;
@@ -2100,6 +2216,21 @@ void M68K_StartEmu(void *addr, void *fdt)
     __m68k.JIT_CONTROL2 |= (emu68_ccrd  << JC2B_CCR_SCAN_DEPTH); 
     __m68k.JIT_CONTROL2 |= ((cs_dist - 1) << JC2B_CHIP_SLOWDOWN_RATIO);
     __m68k.JIT_CONTROL2 |= blitwait ? JC2F_BLITWAIT : 0;
+    __m68k.JIT_CONTROL2 |= EMU68_BLOCK_CHAINING ? JC2F_CHAIN_UNITS : 0;
+    __m68k.JIT_CONTROL2 |= EMU68_BRANCH_CACHE ? JC2F_BRANCH_CACHE : 0;
+    __m68k.JIT_CONTROL2 |= EMU68_SHADOW_RETURN_STACK ? JC2F_RETURN_STACK : 0;
+    __m68k.JIT_CONTROL2 |= EMU68_TIERED_JIT ? JC2F_TIERED_JIT : 0;
+    __m68k.JIT_CONTROL2 |= EMU68_LAZY_FLAGS ? JC2F_LAZY_FLAGS : 0;
+    __m68k.JIT_CONTROL2 |= EMU68_IR_PASSES ? JC2F_IR_PASSES : 0;
+    __m68k.JIT_CONTROL2 |= EMU68_PEEPHOLE ? JC2F_PEEPHOLE : 0;
+    __m68k.JIT_CONTROL2 |= EMU68_SIDE_ENTRIES ? JC2F_SIDE_ENTRIES : 0;
+    __m68k.JIT_CONTROL2 |= smc_protect ? JC2F_SMC_PROTECT : 0;
+    __m68k.JIT_CONTROL2 |= EMU68_BACKGROUND_VERIFY ? JC2F_BG_VERIFY : 0;
+    __m68k.JIT_CONTROL2 |= EMU68_PIN_UNITS ? (JC2_PIN_ROM | JC2_PIN_HOT) << JC2B_PIN : 0;
+    __m68k.JIT_CONTROL2 |= (EMU68_WARM_RESET && warm_reset) ? JC2F_WARM_RESET : 0;
+    __m68k.JIT_CONTROL2 |= EMU68_BLOCK_LOOPS ? JC2F_BLOCK_LOOPS : 0;
+    __m68k.JIT_CONTROL2 |= EMU68_LOOP_PREFETCH ? (EMU68_PREFETCH_DISTANCE & JC2_PREFETCH_MASK) << JC2B_PREFETCH : 0;
+    __m68k.JIT_TIER_THRESH = EMU68_TIER_THRESHOLD;
 
 #else
     __m68k.D[0].u32 = BE32((uint32_t)pitch);
@@ -2114,13 +2245,28 @@ void M68K_StartEmu(void *addr, void *fdt)
     __m68k.SR = BE16(SR_S | SR_IPL);
     __m68k.FPCR = 0;
     __m68k.JIT_CACHE_TOTAL = tlsf_get_total_size(jit_tlsf);
-    __m68k.JIT_CACHE_FREE = tlsf_get_free_size(jit_tlsf);
+    __m68k.JIT_CACHE_FREE = M68K_GetCacheFree();
     __m68k.JIT_UNIT_COUNT = 0;
     __m68k.JIT_SOFTFLUSH_THRESH = EMU68_WEAK_CFLUSH_LIMIT;
     __m68k.JIT_CONTROL = EMU68_WEAK_CFLUSH ? JCCF_SOFT : 0;
     __m68k.JIT_CONTROL |= (EMU68_M68K_INSN_DEPTH & JCCB_INSN_DEPTH_MASK) << JCCB_INSN_DEPTH;
     __m68k.JIT_CONTROL |= (EMU68_BRANCH_INLINE_DISTANCE & JCCB_INLINE_RANGE_MASK) << JCCB_INLINE_RANGE;
     __m68k.JIT_CONTROL |= (EMU68_MAX_LOOP_COUNT & JCCB_LOOP_COUNT_MASK) << JCCB_LOOP_COUNT;
+    __m68k.JIT_CONTROL2 = EMU68_BLOCK_CHAINING ? JC2F_CHAIN_UNITS : 0;
+    __m68k.JIT_CONTROL2 |= EMU68_BRANCH_CACHE ? JC2F_BRANCH_CACHE : 0;
+    __m68k.JIT_CONTROL2 |= EMU68_SHADOW_RETURN_STACK ? JC2F_RETURN_STACK : 0;
+    __m68k.JIT_CONTROL2 |= EMU68_TIERED_JIT ? JC2F_TIERED_JIT : 0;
+    __m68k.JIT_CONTROL2 |= EMU68_LAZY_FLAGS ? JC2F_LAZY_FLAGS : 0;
+    __m68k.JIT_CONTROL2 |= EMU68_IR_PASSES ? JC2F_IR_PASSES : 0;
+    __m68k.JIT_CONTROL2 |= EMU68_PEEPHOLE ? JC2F_PEEPHOLE : 0;
+    __m68k.JIT_CONTROL2 |= EMU68_SIDE_ENTRIES ? JC2F_SIDE_ENTRIES : 0;
+    __m68k.JIT_CONTROL2 |= smc_protect ? JC2F_SMC_PROTECT : 0;
+    __m68k.JIT_CONTROL2 |= EMU68_BACKGROUND_VERIFY ? JC2F_BG_VERIFY : 0;
+    __m68k.JIT_CONTROL2 |= EMU68_PIN_UNITS ? (JC2_PIN_ROM | JC2_PIN_HOT) << JC2B_PIN : 0;
+    __m68k.JIT_CONTROL2 |= (EMU68_WARM_RESET && warm_reset) ? JC2F_WARM_RESET : 0;
+    __m68k.JIT_CONTROL2 |= EMU68_BLOCK_LOOPS ? JC2F_BLOCK_LOOPS : 0;
+    __m68k.JIT_CONTROL2 |= EMU68_LOOP_PREFETCH ? (EMU68_PREFETCH_DISTANCE & JC2_PREFETCH_MASK) << JC2B_PREFETCH : 0;
+    __m68k.JIT_TIER_THRESH = EMU68_TIER_THRESHOLD;
     *(uint32_t*)(intptr_t)(BE32(__m68k.ISP.u32)) = 0;
 #endif
     of_node_t *node = dt_find_node("/chosen");
@@ -2168,6 +2314,15 @@ void M68K_StartEmu(void *addr, void *fdt)
         }       
     }
 
+#if EMU68_JIT_SNAPSHOT
+    if (jit_snapshot != NULL)
+    {
+        M68K_LoadSnapshot(jit_snapshot, jit_snapshot_size);
+        tlsf_free(tlsf, jit_snapshot);
+        jit_snapshot = NULL;
+    }
+#endif
+
     kprintf("[JIT]\n");
     M68K_PrintContext(&__m68k);
 
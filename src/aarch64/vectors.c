@@ -748,6 +748,8 @@ int SYSValidateUnit(uint32_t vector, uint64_t *ctx, uint64_t elr, uint64_t spsr,
     if (unit)
     {
         unit->mt_ARMEntryPoint = (void*)corrected_far;
+        M68K_ProtectUnitPages(unit);
+        M68K_LinkUnit(unit);
         elr = corrected_far;
         asm volatile("msr ELR_EL1, %0"::"r"(elr));
         return 1;
@@ -1078,6 +1080,10 @@ int SYSPageFaultWriteHandler(uint32_t vector, uint64_t *ctx, uint64_t elr, uint6
         kprintf("PageFault with valid instruction syndrome: %08x\n", esr);
     }
 
+    /* Permission fault on a page holding translated code. Flush the code and repeat the write */
+    if ((esr & 0x3c) == 0x0c && M68K_CodePageWritten((uint32_t)far))
+        return 1;
+
     size = getOPsize(opcode);
 
     D(kprintf("[JIT:SYS] Fage fault: opcode %08x, %s %p size %d\n", opcode, "write to", far, size));
@@ -1502,6 +1508,9 @@ int SYSPageFaultWriteHandler(uint32_t vector, uint64_t *ctx, uint64_t elr, uint6
     if (!handled)
     {    
         kprintf("[JIT:SYS] Unhandled page fault: opcode %08x, write to %p\n", opcode, far);
+#if EMU68_LAZY_PC
+        kprintf("[JIT:SYS] M68k PC: %08x\n", M68K_GetPCFromARM(elr));
+#endif
     }
 
     elr += 4;
@@ -2148,6 +2157,9 @@ int SYSPageFaultReadHandler(uint32_t vector, uint64_t *ctx, uint64_t elr, uint64
     if (!handled)
     {    
         kprintf("[JIT:SYS] Unhandled page fault: opcode %08x, read from %p\n", opcode, far);
+#if EMU68_LAZY_PC
+        kprintf("[JIT:SYS] M68k PC: %08x\n", M68K_GetPCFromARM(elr));
+#endif
     }
 
     elr += 4;
@@ -2314,6 +2326,9 @@ void SYSHandler(uint32_t vector, uint64_t *ctx)
     {
         kprintf("[JIT:SYS] Exception with vector %04x. ELR=%p, SPSR=%08x, ESR=%p, FAR=%p\n", vector, elr, spsr, esr, far);
         kprintf("[JIT:SYS] Failed instruction: %08x\n", LE32(*(uint32_t*)elr));
+#if EMU68_LAZY_PC
+        kprintf("[JIT:SYS] M68k PC: %08x\n", M68K_GetPCFromARM(elr));
+#endif
 
         for (int i=0; i < 16; i++)
         {
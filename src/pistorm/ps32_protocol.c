@@ -1609,6 +1609,24 @@ void ps_housekeeper()
 
             pin_prev = pin;
 
+#if EMU68_WARM_RESET
+            /* Warm reset stops m68k in the main loop and keeps it there until reset is released */
+            if (__m68k_state->JIT_CONTROL2 & JC2F_WARM_RESET)
+            {
+                if ((pin & (1 << PIN_KBRESET)) == 0 && __m68k_state->INT.RESET == 0)
+                {
+                    kprintf("[HKEEP] Warm reset of m68k...\n");
+                    __m68k_state->INT.RESET = 1;
+                    asm volatile("sev":::"memory");
+                }
+                else if ((pin & (1 << PIN_KBRESET)) != 0 && __m68k_state->INT.RESET == 1)
+                {
+                    __m68k_state->INT.RESET = 2;
+                    asm volatile("sev":::"memory");
+                }
+            }
+            else
+#endif
             if ((pin & (1 << PIN_KBRESET)) == 0) {
                 kprintf("[HKEEP] Houskeeper will reset RasPi now...\n");
 
@@ -735,6 +735,9 @@ char * strstr(const char *s, const char *find)
 
 void * tlsf;
 void * jit_tlsf;
+/* Pages mapped behind the JIT pool, added to it when it runs full */
+uintptr_t jit_reserve;
+uintptr_t jit_reserve_size;
 
 static const int32_t table[] = {
 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,